@@ -83,21 +83,28 @@
 				'src/external_copy/string.cc',
 				'src/isolate/allocator_nortti.cc',
 				'src/isolate/environment.cc',
+				'src/isolate/eval_cache.cc',
 				'src/isolate/cpu_profile_manager.cc',
 				'src/isolate/executor.cc',
 				'src/isolate/holder.cc',
 				'src/isolate/inspector.cc',
+				'src/isolate/memory_governor.cc',
+				'src/isolate/memory_group.cc',
 				'src/isolate/platform_delegate.cc',
 				'src/isolate/scheduler.cc',
 				'src/isolate/stack_trace.cc',
 				'src/isolate/three_phase_task.cc',
+				'src/lib/file.cc',
 				'src/lib/thread_pool.cc',
 				'src/lib/timer.cc',
 				'src/module/callback.cc',
+				'src/module/code_cache.cc',
 				'src/module/context_handle.cc',
 				'src/module/evaluation.cc',
 				'src/module/external_copy_handle.cc',
 				'src/module/isolate.cc',
+				'src/module/isolate_group_handle.cc',
+				'src/module/isolate_pool_handle.cc',
 				'src/module/isolate_handle.cc',
 				'src/module/lib_handle.cc',
 				'src/module/module_handle.cc',
@@ -105,7 +112,8 @@
 				'src/module/reference_handle.cc',
 				'src/module/script_handle.cc',
 				'src/module/session_handle.cc',
-				'src/module/transferable.cc'
+				'src/module/transferable.cc',
+				'src/module/wasm_cache.cc'
 			],
 			'conditions': [
 				[ 'OS != "win"', {
@@ -6,6 +6,7 @@ declare namespace IsolatedVM {
 		| number
 		| boolean
 		| Isolate
+		| IsolateGroup
 		| Context
 		| Script
 		| ExternalCopy<any>
@@ -30,6 +31,12 @@ declare namespace IsolatedVM {
 		private __ivm_isolate: undefined;
 		constructor(options?: IsolateOptions);
 
+		/**
+		 * Builds a new isolate on a background thread so the event loop isn't blocked while its heap
+		 * and default context are set up.
+		 */
+		static create(options?: IsolateOptions): Promise<Isolate>;
+
 		/**
 		 * The total CPU time spent in this isolate. CPU time is the amount of time the isolate has
 		 * spent actively doing work on the CPU.
@@ -45,6 +52,11 @@ declare namespace IsolatedVM {
 		 */
 		readonly isDisposed: boolean;
 
+		/**
+		 * Flag that indicates whether this isolate is waiting to be rebuilt after `hibernate()`.
+		 */
+		readonly isHibernating: boolean;
+
 		/**
 		 * The total wall time spent in this isolate. Wall time is the amount of time the isolate has
 		 * been running, including passive time spent waiting (think "wall" like a clock on the wall).
@@ -73,7 +85,12 @@ declare namespace IsolatedVM {
 		 *
 		 * @param warmup_script - Optional script to "warmup" the snapshot by triggering code compilation
 		 */
-		static createSnapshot(scripts: SnapshotScriptInfo[], warmup_script?: string): ExternalCopy<ArrayBuffer>;
+		static createSnapshot(scripts: SnapshotScriptInfo[], warmup_script?: string, options?: SnapshotOptions): ExternalCopy<ArrayBuffer>;
+
+		/**
+		 * Same as `createSnapshot` except the snapshot is built on a background thread.
+		 */
+		static createSnapshotAsync(scripts: SnapshotScriptInfo[], warmup_script?: string, options?: SnapshotOptions): Promise<ExternalCopy<ArrayBuffer>>;
 
 		compileScript(code: string, scriptInfo?: ScriptInfo): Promise<Script>;
 		compileScriptSync(code: string, scriptInfo?: ScriptInfo): Script;
@@ -81,15 +98,43 @@ declare namespace IsolatedVM {
 		compileModule(code: string, options?: CompileModuleOptions): Promise<Module>;
 		compileModuleSync(code: string, options?: CompileModuleOptions): Module;
 
+		/**
+		 * Compiles a whole module graph in one step. Each module is registered under its `specifier`
+		 * so any of them can be instantiated without a resolve callback.
+		 */
+		compileModules(modules: CompileModulesEntry[]): Promise<Module[]>;
+		compileModulesSync(modules: CompileModulesEntry[]): Module[];
+
+		/**
+		 * Removes a module from the isolate's module registry. Returns `true` if anything was registered
+		 * under `specifier`.
+		 */
+		unregisterModule(specifier: string): Promise<boolean>;
+		unregisterModuleSync(specifier: string): boolean;
+
+		/**
+		 * Compiles WebAssembly from a file or an `ExternalCopy` of an `ArrayBuffer`, streaming it into
+		 * v8 in chunks. The compiled module can be copied into any isolate.
+		 */
+		compileWasm(source: string | ExternalCopy<ArrayBuffer>, options?: { filename?: string }): Promise<ExternalCopy<WebAssembly.Module>>;
+
 		createContext(options?: ContextOptions): Promise<Context>;
 		createContextSync(options?: ContextOptions): Context;
 
 		createInspectorSession(): InspectorSession;
 
 		/**
-		 * Destroys this isolate and invalidates all references obtained from it.
+		 * Destroys this isolate and invalidates all references obtained from it. The heap is freed on a
+		 * background thread and the returned promise resolves once that's finished.
 		 */
-		dispose(): void;
+		dispose(): Promise<void>;
+
+		/**
+		 * Throws away the heap of an idle isolate which has no outstanding references. The isolate is
+		 * rebuilt from its original options (and snapshot) the next time it's used.
+		 */
+		hibernate(): Promise<void>;
+		hibernateSync(): void;
 
 		/**
 		 * Returns heap statistics from v8.
@@ -107,6 +152,12 @@ declare namespace IsolatedVM {
 		getHeapStatistics(): Promise<HeapStatistics>;
 		getHeapStatisticsSync(): HeapStatistics;
 
+		/**
+		 * Returns the statistics most recently published by this isolate. Statistics are published
+		 * after every garbage collection and every task, and reading them never waits for the isolate.
+		 */
+		getStatsSnapshot(): StatsSnapshot;
+
 		/**
 		 * Start profiling against the isolate with a specific title
 		 * 
@@ -136,6 +187,73 @@ declare namespace IsolatedVM {
 		 */
 		memoryLimit?: number;
 
+		/**
+		 * Optional threshold, in MB, which must be less than `memoryLimit`. When a full garbage
+		 * collection finishes with the isolate above this threshold v8 will be asked to collect garbage
+		 * as aggressively as it can. If the isolate is still over the threshold after that then
+		 * `onSoftMemoryLimit` is invoked. The isolate is not terminated.
+		 */
+		softMemoryLimit?: number;
+
+		/**
+		 * Callback invoked with the number of bytes in use when the isolate stays above
+		 * `softMemoryLimit`. This is invoked at most once each time the threshold is crossed.
+		 */
+		onSoftMemoryLimit?: (bytesUsed: number) => void;
+
+		/**
+		 * Initial size of the old generation, in MB. This must not exceed `memoryLimit`.
+		 */
+		initialOldGenerationSize?: number;
+
+		/**
+		 * Initial size of the young generation, in MB.
+		 */
+		initialYoungGenerationSize?: number;
+
+		/**
+		 * Optional name for the kind of work this isolate will do. New isolates start with heaps sized
+		 * according to the usage of previously disposed isolates with the same `workload`.
+		 */
+		workload?: string;
+
+		/**
+		 * Don't build the internal default context until it's needed. This lowers the footprint of
+		 * isolates which only run code in contexts from `createContext`. Compiling scripts or modules,
+		 * or copying an error out of the isolate, still builds it.
+		 */
+		lazyDefaultContext?: boolean;
+
+		/**
+		 * Optional shared memory budget. When set, `memoryLimit` acts as a ceiling for this isolate
+		 * and the group as a whole is bounded by the group's `memoryLimit`.
+		 */
+		group?: IsolateGroup;
+
+		/**
+		 * Memory, in MB, reserved for this isolate in its `group`. An isolate which is using less than
+		 * its floor will not be terminated because of other isolates in the group.
+		 */
+		memoryFloor?: number;
+
+		/**
+		 * When set, an isolate which has had no work scheduled for this many milliseconds will run
+		 * pending v8 idle tasks and start an incremental garbage collection. Default is 0, which
+		 * disables idle collection.
+		 */
+		idleCollectionDelay?: number;
+
+		/**
+		 * Number of fresh contexts to build ahead of time for `createContext`. Default is 0.
+		 */
+		contextPoolSize?: number;
+
+		/**
+		 * Number of compiled scripts to keep for `context.eval` and `context.evalClosure`, so running the
+		 * same code again skips compilation. Default is 0, which disables the cache.
+		 */
+		evalCacheSize?: number;
+
 		/**
 		 * Enable v8 inspector support in this isolate. See `inspector-example.js` in this repository
 		 * for an example of how to use this.
@@ -157,8 +275,81 @@ declare namespace IsolatedVM {
 		onCatastrophicError?: (message: string) => void;
 	};
 
+	/**
+	 * A memory budget which is shared by many isolates.
+	 */
+	export class IsolateGroup {
+		constructor(options: IsolateGroupOptions);
+
+		/**
+		 * The budget of this group, in bytes.
+		 */
+		readonly memoryLimit: number;
+
+		/**
+		 * The amount of memory currently charged to this group, in bytes.
+		 */
+		readonly memoryUsage: number;
+	}
+
+	export type IsolateGroupOptions = {
+		/**
+		 * Memory limit for all isolates in this group combined, in MB. The minimum is 8MB.
+		 */
+		memoryLimit: number;
+	};
+
+	/**
+	 * Keeps a number of isolates, all built from the same options, ready to hand out. Isolates are
+	 * built on background threads and replaced as they are taken.
+	 */
+	export class IsolatePool {
+		constructor(options?: IsolatePoolOptions);
+
+		/**
+		 * Takes an isolate from the pool, or builds one if the pool is empty.
+		 */
+		acquire(): Isolate;
+
+		/**
+		 * Disposes all isolates waiting in the pool.
+		 */
+		dispose(): void;
+
+		readonly size: number;
+		readonly available: number;
+
+		/**
+		 * Number of `acquire()` calls served from the pool.
+		 */
+		readonly hits: number;
+
+		/**
+		 * Number of `acquire()` calls which found the pool empty.
+		 */
+		readonly misses: number;
+	}
+
+	export type IsolatePoolOptions = {
+		/**
+		 * Number of isolates to keep ready. Default is 1.
+		 */
+		size?: number;
+
+		/**
+		 * Options for each isolate.
+		 */
+		isolate?: IsolateOptions;
+	};
+
 	export type ContextOptions = {
 		inspector?: boolean;
+
+		/**
+		 * Restore one of the extra contexts from this isolate's snapshot instead of making an empty
+		 * context. See `SnapshotOptions.contexts`.
+		 */
+		snapshotIndex?: number;
 	};
 
 	export type HeapStatistics = {
@@ -171,6 +362,8 @@ declare namespace IsolatedVM {
 		malloced_memory: number;
 		peak_malloced_memory: number;
 		does_zap_garbage: number;
+		number_of_native_contexts: number;
+		number_of_detached_contexts: number;
 
 		/**
 		 * The total amount of currently allocated memory which is not included in the v8 heap but
@@ -179,6 +372,36 @@ declare namespace IsolatedVM {
 		externally_allocated_size: number;
 	};
 
+	export type StatsSnapshot = Omit<HeapStatistics, "does_zap_garbage"> & {
+		cpuTime: bigint;
+		wallTime: bigint;
+
+		/**
+		 * Number of tasks which were waiting to run when these statistics were published.
+		 */
+		queueDepth: number;
+
+		/**
+		 * Lookups in the `evalCacheSize` cache which found compiled code, and those which didn't.
+		 */
+		evalCacheHits: number;
+		evalCacheMisses: number;
+
+		/**
+		 * When these statistics were published, in milliseconds since epoch.
+		 */
+		timestamp: number;
+	};
+
+	export type CompileModulesEntry = ScriptInfo & {
+		code: string;
+		specifier: string;
+		/**
+		 * Same as the `meta` option of `compileModule`.
+		 */
+		meta?: (meta: any) => void;
+	}
+
 	export type CompileModuleOptions = ScriptInfo & {
 		/**
 		 * Callback which will be invoked the first time this module accesses `import.meta`. The `meta`
@@ -186,6 +409,14 @@ declare namespace IsolatedVM {
 		 * `compileModule` from within the same isolate.
 		 */
 		meta?: (meta: any) => void;
+
+		/**
+		 * Registers the module in the isolate's module registry under this specifier, replacing any
+		 * module already registered there. Registered modules satisfy `import` statements of modules
+		 * instantiated without a `resolveCallback`, and dynamic `import()` calls from any code in the
+		 * isolate. Use `isolate.unregisterModule()` to remove it.
+		 */
+		specifier?: string;
 	}
 
 	/**
@@ -249,6 +480,14 @@ declare namespace IsolatedVM {
 		private __ivm_script: undefined;
 		private constructor();
 
+		/**
+		 * Produces cached data for this script which can be passed as `cachedData` to `compileScript`.
+		 * Unlike `produceCachedData` this includes every function which has been compiled so far, so
+		 * calling it after a warmup workload saves consumers from compiling those functions lazily.
+		 */
+		createCachedData(): Promise<ExternalCopy<ArrayBuffer>>;
+		createCachedDataSync(): ExternalCopy<ArrayBuffer>;
+
 		/**
 		 * Releases the reference to this script, allowing the script data to be garbage collected.
 		 * Functions and data created in the isolate by previous invocations to `script.run(...)` will
@@ -293,18 +532,19 @@ declare namespace IsolatedVM {
 		 * @param context The context the module should use.
 		 * @param resolveCallback This callback is responsible for resolving all direct and indirect
 		 * dependencies of this module. It accepts two parameters: specifier and referrer. It must
-		 * return a Module instance or a promise which will be used to satisfy the dependency.
+		 * return a Module instance or a promise which will be used to satisfy the dependency. If
+		 * omitted, dependencies are resolved from the isolate's module registry.
 		 */
 		instantiate(
 			context: Context,
-			resolveCallback: (
+			resolveCallback?: (
 				specifier: string,
 				referrer: Module
 			) => Module | Promise<Module>
 		): Promise<void>;
 		instantiateSync(
 			context: Context,
-			resolveCallback: (specifier: string, referrer: Module) => Module
+			resolveCallback?: (specifier: string, referrer: Module) => Module
 		): void;
 
 		/**
@@ -316,6 +556,13 @@ declare namespace IsolatedVM {
 		evaluate(options?: ScriptRunOptions): Promise<Transferable>;
 		evaluateSync(options?: ScriptRunOptions): Transferable;
 
+		/**
+		 * Same as `script.createCachedData()`, the result can be passed as `cachedData` to
+		 * `compileModule`.
+		 */
+		createCachedData(): Promise<ExternalCopy<ArrayBuffer>>;
+		createCachedDataSync(): ExternalCopy<ArrayBuffer>;
+
 		/**
 		 * Releases this module. This behaves the same as other `.release()` methods.
 		 */
@@ -606,6 +853,93 @@ declare namespace IsolatedVM {
 		createSync(context: Context): Reference<any>;
 	}
 
+	/**
+	 * Starts sampling the memory used by this process. On Linux this is read from the process's
+	 * cgroup when available, otherwise the process RSS is used. All isolates receive a memory pressure
+	 * notification when usage crosses a threshold. Pass no options to stop the governor.
+	 */
+	export function setMemoryGovernor(options?: MemoryGovernorOptions): void;
+
+	/**
+	 * Asks every isolate to run a low-memory garbage collection and release any memory it is holding
+	 * onto for reuse.
+	 */
+	export function trimMemory(): void;
+
+	/**
+	 * Enables the process-wide code cache used by `compileScript` and `compileModule` when no
+	 * `cachedData` is supplied. Pass no options to disable it.
+	 */
+	export function setCodeCache(options?: CodeCacheOptions): void;
+
+	/**
+	 * Persists code cache entries as files in an existing directory so they survive restarts. Pass no
+	 * arguments to stop using the directory.
+	 */
+	export function setCodeCacheDirectory(path?: string): void;
+
+	/**
+	 * Returns the contents and hit rate of the process-wide code cache.
+	 */
+	export function getCodeCacheStatistics(): CodeCacheStatistics;
+
+	export type CodeCacheOptions = {
+		/**
+		 * Total size, in MB, of cached data to keep. Default is 0, which disables the cache.
+		 */
+		maxSize?: number;
+	};
+
+	export type CodeCacheStatistics = {
+		entries: number;
+		size: number;
+		maxSize: number;
+		hits: number;
+		misses: number;
+	};
+
+	/**
+	 * Enables the process-wide cache of compiled WebAssembly modules used by `new WebAssembly.Module`
+	 * and `WebAssembly.compile` in every isolate. Pass no options to disable it.
+	 */
+	export function setWasmCache(options?: WasmCacheOptions): void;
+
+	/**
+	 * Returns the contents and hit rate of the process-wide WebAssembly cache.
+	 */
+	export function getWasmCacheStatistics(): WasmCacheStatistics;
+
+	export type WasmCacheOptions = {
+		/**
+		 * Number of compiled modules to keep. Default is 0, which disables the cache.
+		 */
+		maxEntries?: number;
+	};
+
+	export type WasmCacheStatistics = {
+		entries: number;
+		maxEntries: number;
+		hits: number;
+		misses: number;
+	};
+
+	export type MemoryGovernorOptions = {
+		/**
+		 * Threshold, in MB, at which all isolates receive a "moderate" memory pressure notification.
+		 */
+		moderate?: number;
+
+		/**
+		 * Threshold, in MB, at which all isolates receive a "critical" memory pressure notification.
+		 */
+		critical?: number;
+
+		/**
+		 * How often to sample memory usage, in milliseconds. Default is 1000.
+		 */
+		interval?: number;
+	};
+
 	export type ThreadCpuProfile = {
 		threadId: number;
 		profile: CpuProfile;
@@ -659,6 +993,11 @@ declare namespace IsolatedVM {
 		 * `cachedDataProduced` is never set.
 		 */
 		produceCachedData?: boolean;
+		/**
+		 * Compile every function up front instead of the first time it's called. With
+		 * `produceCachedData` the cached data will contain every function body.
+		 */
+		eager?: boolean;
 	};
 
 	export type CachedDataResult = {
@@ -710,6 +1049,26 @@ declare namespace IsolatedVM {
 		 */
 		code: string;
 	};
+
+	export type SnapshotOptions = {
+		/**
+		 * Reuse snapshots built from the same scripts, warmup script, and v8 version within this
+		 * process. Concurrent requests for the same snapshot share a single build.
+		 */
+		cache?: boolean;
+
+		/**
+		 * Directory where snapshots are saved and looked up, keyed by the same content hash. The
+		 * directory must already exist.
+		 */
+		cacheDirectory?: string;
+
+		/**
+		 * Extra contexts to embed in the snapshot, each set up by running its own list of scripts in a
+		 * fresh context. Restore them with `createContext({ snapshotIndex })`.
+		 */
+		contexts?: SnapshotScriptInfo[][];
+	};
 	export type ScriptInfo = CachedDataOptions & ScriptOrigin;
 
 	/**
@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <unordered_set>
 
 using namespace v8;
 
@@ -506,4 +507,35 @@ auto ExternalCopyArrayBufferView::CopyInto(bool transfer_in) -> Local<Value> {
 	}
 }
 
+/**
+ * ExternalCopyWasmModule implementation
+ */
+namespace {
+lockable_t<std::unordered_set<ExternalCopyWasmModule*>> wasm_modules;
+} // anonymous namespace
+
+ExternalCopyWasmModule::ExternalCopyWasmModule(CompiledWasmModule module) :
+	ExternalCopy(static_cast<int>(module.GetWireBytesRef().size())),
+	module(std::move(module)) {
+	wasm_modules.write()->insert(this);
+}
+
+ExternalCopyWasmModule::~ExternalCopyWasmModule() {
+	wasm_modules.write()->erase(this);
+}
+
+auto ExternalCopyWasmModule::CopyInto(bool /*transfer_in*/) -> Local<Value> {
+	auto lock = module.read();
+	if (!*lock) {
+		throw RuntimeGenericError("Module was released");
+	}
+	return Unmaybe(WasmModuleObject::FromCompiledModule(Isolate::GetCurrent(), **lock));
+}
+
+void ExternalCopyWasmModule::ReleaseAll() {
+	for (auto* copy : *wasm_modules.write()) {
+		copy->module.write()->reset();
+	}
+}
+
 } // namespace ivm
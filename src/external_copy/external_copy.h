@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <cstdlib>
 #include <memory>
+#include <optional>
 #include <vector>
 
 #include "isolate/generic/array.h"
@@ -114,4 +115,22 @@ class ExternalCopyArrayBufferView : public ExternalCopy {
 		auto CopyInto(bool transfer_in = false) -> v8::Local<v8::Value> final;
 };
 
+/**
+ * Compiled WebAssembly.Module instances. The native module is shared, not recompiled, by each copy.
+ */
+class ExternalCopyWasmModule : public ExternalCopy {
+	public:
+		explicit ExternalCopyWasmModule(v8::CompiledWasmModule module);
+		ExternalCopyWasmModule(const ExternalCopyWasmModule&) = delete;
+		auto operator= (const ExternalCopyWasmModule&) = delete;
+		~ExternalCopyWasmModule() final;
+		auto CopyInto(bool transfer_in = false) -> v8::Local<v8::Value> final;
+
+		// v8 won't shut down while any native module is alive, so every copy is released before exit
+		static void ReleaseAll();
+
+	private:
+		lockable_t<std::optional<v8::CompiledWasmModule>> module;
+};
+
 } // namespace ivm
@@ -1,5 +1,6 @@
 #include "isolate/environment.h"
 #include "./string.h"
+#include <algorithm>
 #include <cstring>
 
 using namespace v8;
@@ -77,11 +78,49 @@ class ExternalStringOneByte final : public v8::String::ExternalOneByteStringReso
 		std::weak_ptr<IsolateEnvironment> weak_env;
 };
 
+/**
+ * Feeds a string to v8's streaming compiler in chunks. v8 takes ownership of each chunk. Chunks stay
+ * an even length so two-byte characters are never split.
+ */
+class StringSourceStream final : public ScriptCompiler::ExternalSourceStream {
+	public:
+		explicit StringSourceStream(std::shared_ptr<std::vector<char>> value) : value{std::move(value)} {}
+
+		auto GetMoreData(const uint8_t** src) -> size_t final {
+			constexpr size_t kChunkSize = 64 * 1024;
+			auto size = std::min(kChunkSize, value->size() - offset);
+			if (size == 0) {
+				return 0;
+			}
+			auto* chunk = new uint8_t[size];
+			std::memcpy(chunk, value->data() + offset, size);
+			offset += size;
+			*src = chunk;
+			return size;
+		}
+
+	private:
+		std::shared_ptr<std::vector<char>> value;
+		size_t offset = 0;
+};
+
 } // anonymous namespace
 
 /**
  * ExternalCopyString implementation
  */
+auto ExternalCopyString::GetStreamedSource() const -> std::unique_ptr<ScriptCompiler::StreamedSource> {
+	return std::make_unique<ScriptCompiler::StreamedSource>(
+		std::make_unique<StringSourceStream>(value),
+		one_byte ? ScriptCompiler::StreamedSource::ONE_BYTE : ScriptCompiler::StreamedSource::TWO_BYTE
+	);
+}
+
+void ExternalCopyString::AppendTo(std::string& key) const {
+	key += one_byte ? '1' : '2';
+	key.append(value->data(), value->size());
+}
+
 ExternalCopyString::ExternalCopyString(Local<String> string) :
 		ExternalCopy{static_cast<int>((string->Length() << (string->IsOneByte() ? 0 : 1)) + sizeof(ExternalCopyString))} {
 	if (string->IsOneByte()) {
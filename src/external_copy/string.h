@@ -1,6 +1,7 @@
 #pragma once
 #include "external_copy.h"
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace ivm {
@@ -19,6 +20,10 @@ class ExternalCopyString final : public ExternalCopy {
 
 		explicit operator bool() const { return static_cast<bool>(value); }
 		auto CopyInto(bool transfer_in = false) -> v8::Local<v8::Value> final;
+		// Appends the exact contents of this string to a cache key
+		void AppendTo(std::string& key) const;
+		// Source for v8's off-thread compiler which reads from this string without first copying it into a heap
+		auto GetStreamedSource() const -> std::unique_ptr<v8::ScriptCompiler::StreamedSource>;
 
 	private:
 		std::shared_ptr<std::vector<char>> value;
@@ -54,18 +54,23 @@ auto LimitedAllocator::Check(const size_t length) -> bool {
 		Isolate* isolate = Isolate::GetCurrent();
 		isolate->GetHeapStatistics(&heap_statistics);
 		v8_heap = heap_statistics.used_heap_size();
-		if (v8_heap + env.extra_allocated_memory + length > limit + env.misc_memory_size) {
+		if (!Fits(length)) {
 			// This is might be dangerous but the tests pass soooo..
 			isolate->LowMemoryNotification();
 			isolate->GetHeapStatistics(&heap_statistics);
 			v8_heap = heap_statistics.used_heap_size();
-			if (v8_heap + env.extra_allocated_memory + length > limit + env.misc_memory_size) {
+			if (!Fits(length)) {
 				return false;
 			}
 		}
 		next_check = v8_heap + env.extra_allocated_memory + length + 1024 * 1024;
 	}
-	return v8_heap + env.extra_allocated_memory + length <= limit + env.misc_memory_size;
+	return Fits(length);
+}
+
+auto LimitedAllocator::Fits(size_t length) const -> bool {
+	size_t total_memory = v8_heap + env.extra_allocated_memory + length;
+	return total_memory <= limit + env.misc_memory_size && env.FitsMemoryGroup(total_memory);
 }
 
 LimitedAllocator::LimitedAllocator(IsolateEnvironment& env, size_t limit) : env(env), limit(limit), v8_heap(1024 * 1024 * 4), next_check(1024 * 1024) {}
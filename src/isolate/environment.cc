@@ -1,6 +1,8 @@
 #include "environment.h"
 #include "allocator.h"
+#include "eval_cache.h"
 #include "inspector.h"
+#include "memory_governor.h"
 #include "isolate/cpu_profile_manager.h"
 #include "isolate/generic/error.h"
 #include "platform_delegate.h"
@@ -8,14 +10,17 @@
 #include "external_copy/external_copy.h"
 #include "scheduler.h"
 #include "lib/suspend.h"
+#include "lib/timer.h"
 #include <algorithm>
 #include <chrono>
 #include <climits>
 #include <cmath>
 #include <cstdio>
+#include <cstring>
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <unordered_set>
 #include <vector>
 #include "v8-platform.h"
 #include "v8.h"
@@ -81,7 +86,83 @@ std::atomic<size_t> detail::IsolateSpecificSize{0};
 thread_suspend_handle::initialize suspend_init{};
 
 namespace {
-	std::mutex isolate_allocator_mutex{};
+	// Isolates which are being torn down but haven't been unregistered from the platform yet. Once
+	// `Dispose` returns the address may be handed out again by `Isolate::Allocate` on another thread,
+	// and that isolate can't be registered until the old one is gone.
+	lockable_t<std::unordered_set<Isolate*>, false, true> disposing_isolates;
+
+	// Observed heap sizes for each named workload, in bytes
+	struct WorkloadProfile {
+		size_t old_generation_size = 0;
+		size_t young_generation_size = 0;
+	};
+	lockable_t<std::unordered_map<std::string, WorkloadProfile>> workload_profiles;
+
+	// Threads used by `NewInBackground`
+	thread_pool_t construction_threads{2};
+	thread_pool_t::affinity_t construction_affinity;
+
+	// Tears down isolates disposed by the default thread
+	class Reaper {
+		public:
+			void Push(std::shared_ptr<IsolateEnvironment> env, std::shared_ptr<IsolateHolder> default_holder) {
+				{
+					auto lock = state.write();
+					lock->queue.push_back({ std::move(env), std::move(default_holder) });
+					++lock->pending;
+					if (!lock->started) {
+						lock->started = true;
+						std::thread{[this]() { Run(); }}.detach();
+					}
+				}
+				state.notify_all();
+			}
+
+			// Waits for every queued isolate to be disposed
+			void Drain() {
+				auto lock = state.read<true>();
+				while (lock->pending != 0) {
+					lock.wait();
+				}
+			}
+
+		private:
+			struct Entry {
+				std::shared_ptr<IsolateEnvironment> env;
+				std::shared_ptr<IsolateHolder> default_holder;
+			};
+			struct State {
+				std::deque<Entry> queue;
+				size_t pending = 0;
+				bool started = false;
+			};
+
+			void Run() {
+				while (true) {
+					auto entry = [&]() {
+						auto lock = state.write<true>();
+						while (lock->queue.empty()) {
+							lock.wait();
+						}
+						auto entry = std::move(lock->queue.front());
+						lock->queue.pop_front();
+						return entry;
+					}();
+					entry.env.reset();
+					// The default isolate was kept awake so that any cleanup tasks scheduled by the
+					// destructor could wake it from this thread
+					LockedScheduler::DecrementUvRefForIsolate(entry.default_holder);
+					entry.default_holder.reset();
+					--state.write()->pending;
+					state.notify_all();
+				}
+			}
+
+			lockable_t<State, false, true> state;
+	};
+	// Leaked for the same reason as `default_isolates` in module/isolate.cc: anything left in the
+	// queue at exit can't be safely disposed after nodejs shuts down the platform.
+	auto* reaper = new Reaper;
 } // anonymous namespace
 
 /**
@@ -96,10 +177,14 @@ void IsolateEnvironment::HeapCheck::Epilogue() {
 		Isolate* isolate = env.GetIsolate();
 		HeapStatistics heap;
 		isolate->GetHeapStatistics(&heap);
-		if (heap.used_heap_size() + env.extra_allocated_memory > env.memory_limit) {
+		auto exceeds_limit = [&]() {
+			size_t total_memory = heap.used_heap_size() + env.extra_allocated_memory;
+			return total_memory > env.memory_limit || !env.ChargeMemoryGroup(total_memory);
+		};
+		if (exceeds_limit()) {
 			isolate->LowMemoryNotification();
 			isolate->GetHeapStatistics(&heap);
-			if (heap.used_heap_size() + env.extra_allocated_memory > env.memory_limit) {
+			if (exceeds_limit()) {
 				env.hit_memory_limit = true;
 				env.Terminate();
 				throw FatalRuntimeError("Isolate was disposed during execution due to memory limit");
@@ -186,9 +271,11 @@ void IsolateEnvironment::MarkSweepCompactEpilogue(Isolate* isolate, GCType /*gc_
 	auto* that = static_cast<IsolateEnvironment*>(data);
 	HeapStatistics heap;
 	that->isolate->GetHeapStatistics(&heap);
+	that->peak_used_heap_size = std::max(that->peak_used_heap_size, heap.used_heap_size());
 	size_t total_memory = heap.used_heap_size() + that->extra_allocated_memory;
 	size_t memory_limit = that->memory_limit + that->misc_memory_size;
-	if (total_memory > memory_limit) {
+	bool fits_group = that->ChargeMemoryGroup(total_memory);
+	if (total_memory > memory_limit || !fits_group) {
 		if ((gc_flags & (GCCallbackFlags::kGCCallbackFlagCollectAllAvailableGarbage | GCCallbackFlags::kGCCallbackFlagForced)) == 0) {
 			// Force full garbage collection
 			that->RequestMemoryPressureNotification(MemoryPressureLevel::kCritical);
@@ -208,6 +295,26 @@ void IsolateEnvironment::MarkSweepCompactEpilogue(Isolate* isolate, GCType /*gc_
 				that->did_adjust_heap_limit = false;
 			}
 		}
+		if (that->soft_memory_limit != 0) {
+			if (total_memory > that->soft_memory_limit) {
+				if (!that->did_hit_soft_memory_limit) {
+					if ((gc_flags & (GCCallbackFlags::kGCCallbackFlagCollectAllAvailableGarbage | GCCallbackFlags::kGCCallbackFlagForced)) == 0) {
+						// Try a full garbage collection before bothering the host. This reenters this callback
+						// with the forced flag.
+						that->RequestMemoryPressureNotification(MemoryPressureLevel::kCritical);
+						if (that->did_hit_soft_memory_limit || that->hit_memory_limit) {
+							return;
+						}
+					} else {
+						that->did_hit_soft_memory_limit = true;
+						that->NotifySoftMemoryLimit(total_memory);
+					}
+				}
+			} else {
+				// Re-arm notification once usage drops back under the soft limit
+				that->did_hit_soft_memory_limit = false;
+			}
+		}
 		if (total_memory + total_memory / 4 > memory_limit) {
 			// Send "moderate" pressure at 80%
 			that->RequestMemoryPressureNotification(MemoryPressureLevel::kModerate);
@@ -225,7 +332,8 @@ auto IsolateEnvironment::NearHeapLimitCallback(void* data, size_t current_heap_l
 	that->did_adjust_heap_limit = true;
 	HeapStatistics heap;
 	that->isolate->GetHeapStatistics(&heap);
-	if (heap.used_heap_size() + that->extra_allocated_memory > that->memory_limit + that->misc_memory_size) {
+	size_t total_memory = heap.used_heap_size() + that->extra_allocated_memory;
+	if (total_memory > that->memory_limit + that->misc_memory_size || !that->FitsMemoryGroup(total_memory)) {
 		that->RequestMemoryPressureNotification(MemoryPressureLevel::kCritical, true);
 	} else {
 		that->RequestMemoryPressureNotification(MemoryPressureLevel::kModerate, true);
@@ -261,6 +369,37 @@ void IsolateEnvironment::CheckMemoryPressure() {
 	}
 }
 
+void IsolateEnvironment::NotifySoftMemoryLimit(size_t total_memory) {
+	if (!soft_memory_limit_handler) {
+		return;
+	}
+
+	class SoftMemoryLimitTask : public Task {
+		public:
+			SoftMemoryLimitTask(size_t total_memory, RemoteHandle<Function> handler) :
+				total_memory{total_memory}, handler{std::move(handler)} {}
+
+			void Run() final {
+				auto* isolate = Isolate::GetCurrent();
+				HandleScope handle_scope{isolate};
+				auto fn = handler.Deref();
+				auto context = fn->GetCreationContextChecked();
+				Context::Scope context_scope{context};
+				TryCatch try_catch{isolate};
+				Local<Value> argv[] = { Number::New(isolate, static_cast<double>(total_memory)) };
+				// Errors thrown by the host's callback have nowhere to go
+				fn->Call(context, Undefined(isolate), 1, argv).IsEmpty();
+				isolate->PerformMicrotaskCheckpoint();
+			}
+
+		private:
+			size_t total_memory;
+			RemoteHandle<Function> handler;
+	};
+	soft_memory_limit_handler.GetIsolateHolder()->ScheduleTask(
+		std::make_unique<SoftMemoryLimitTask>(total_memory, soft_memory_limit_handler), false, true);
+}
+
 void IsolateEnvironment::AsyncEntry() {
 	Executor::Lock lock(*this);
 	if (!nodejs_isolate) {
@@ -279,18 +418,19 @@ void IsolateEnvironment::AsyncEntry() {
 		std::queue<unique_ptr<Runnable>> tasks;
 		std::queue<unique_ptr<Runnable>> handle_tasks;
 		std::queue<unique_ptr<Runnable>> interrupts;
+		bool idle_collection = false;
 		{
 			// Grab current tasks
 			auto lock = scheduler->Lock();
 			tasks = ExchangeDefault(lock->tasks);
 			handle_tasks = ExchangeDefault(lock->handle_tasks);
 			interrupts = ExchangeDefault(lock->interrupts);
-			if (tasks.empty() && handle_tasks.empty() && interrupts.empty()) {
+			idle_collection = std::exchange(lock->idle_collection, false);
+			if (tasks.empty() && handle_tasks.empty() && interrupts.empty() && !idle_collection) {
 				lock->DoneRunning();
 				return;
 			}
 		}
-
 		// Execute interrupt tasks
 		while (!interrupts.empty()) {
 			interrupts.front()->Run();
@@ -305,6 +445,7 @@ void IsolateEnvironment::AsyncEntry() {
 
 		// Execute tasks
 		while (!tasks.empty()) {
+			queue_depth = tasks.size();
 			tasks.front()->Run();
 			tasks.pop();
 			if (terminated) {
@@ -312,7 +453,114 @@ void IsolateEnvironment::AsyncEntry() {
 			}
 			CheckMemoryPressure();
 		}
+		queue_depth = 0;
+
+		if (idle_collection) {
+			RunIdleCollection();
+		}
+		PublishStats();
+	}
+}
+
+void IsolateEnvironment::PublishStatsEpilogue(Isolate* /*isolate*/, GCType /*gc_type*/, GCCallbackFlags /*gc_flags*/, void* data) {
+	static_cast<IsolateEnvironment*>(data)->PublishStats();
+}
+
+void IsolateEnvironment::PublishStats() {
+	HeapStatistics heap;
+	isolate->GetHeapStatistics(&heap);
+	// Hide any temporary heap limit increase given by `NearHeapLimitCallback`, same as
+	// `getHeapStatistics`
+	size_t adjustment = heap.heap_size_limit() - initial_heap_size_limit;
+	StatsSnapshot stats;
+	stats.total_heap_size = heap.total_heap_size();
+	stats.total_heap_size_executable = heap.total_heap_size_executable();
+	stats.total_physical_size = heap.total_physical_size();
+	stats.total_available_size = heap.total_available_size() - std::min(adjustment, heap.total_available_size());
+	stats.used_heap_size = heap.used_heap_size();
+	stats.heap_size_limit = heap.heap_size_limit() - adjustment;
+	stats.malloced_memory = heap.malloced_memory();
+	stats.peak_malloced_memory = heap.peak_malloced_memory();
+	stats.externally_allocated_size = extra_allocated_memory;
+	stats.number_of_native_contexts = heap.number_of_native_contexts();
+	stats.number_of_detached_contexts = heap.number_of_detached_contexts();
+	stats.cpu_time = GetCpuTime();
+	stats.wall_time = GetWallTime();
+	stats.queue_depth = queue_depth;
+	if (eval_cache) {
+		stats.eval_cache_hits = eval_cache->GetHits();
+		stats.eval_cache_misses = eval_cache->GetMisses();
+	}
+	stats.timestamp = std::chrono::duration<double, std::milli>{std::chrono::system_clock::now().time_since_epoch()}.count();
+	stats_snapshot.write(stats);
+}
+
+void IsolateEnvironment::ScheduleIdleCollection() {
+	unsigned epoch = task_epoch;
+	if (epoch == idle_collection_epoch) {
+		// Already collected
+		return;
+	}
+	auto delay = uint64_t{idle_collection_delay} * 1000000;
+	auto lock = idle_timer.write();
+	lock->epoch = epoch;
+	lock->deadline = uv_hrtime() + delay;
+	if (!lock->armed) {
+		lock->armed = true;
+		ArmIdleTimer(delay);
+	}
+}
+
+void IsolateEnvironment::ArmIdleTimer(uint64_t delay_ns) {
+	auto ms = static_cast<uint32_t>((delay_ns + 999999) / 1000000);
+	timer_t::wait_detached(ms, [weak_env = weak_from_this()](void* next) {
+		auto env = weak_env.lock();
+		if (env) {
+			env->IdleTimerFired();
+		}
+		timer_t::chain(next);
+	});
+}
+
+void IsolateEnvironment::IdleTimerFired() {
+	auto lock = idle_timer.write();
+	auto now = uv_hrtime();
+	if (now < lock->deadline) {
+		// Work ran since the timer was armed, so wait out the rest of the delay
+		ArmIdleTimer(lock->deadline - now);
+		return;
+	}
+	lock->armed = false;
+	if (task_epoch == lock->epoch) {
+		static_cast<IsolatedScheduler&>(*scheduler).RequestIdleWake(lock->epoch);
+	}
+}
+
+void IsolateEnvironment::WakeForIdleCollection(unsigned epoch) {
+	if (task_epoch == epoch && !terminated) {
+		auto lock = scheduler->Lock();
+		lock->idle_collection = true;
+		lock->WakeIsolate(shared_from_this());
+	}
+}
+
+void IsolateEnvironment::RunIdleCollection() {
+	if (task_epoch != idle_timer.read()->epoch) {
+		// Real work showed up in the meantime
+		return;
+	}
+	idle_collection_epoch = task_epoch;
+	// v8 idle tasks get a deadline as long as the isolate has already been idle, on the theory that
+	// the next quiet period will be similar.
+	auto idle_tasks = ExchangeDefault(scheduler->Lock()->idle_tasks);
+	double deadline = static_cast<double>(uv_hrtime()) / 1e9 + idle_collection_delay / 1000.0;
+	while (!idle_tasks.empty()) {
+		idle_tasks.front()->Run(deadline);
+		idle_tasks.pop();
 	}
+	// Start incremental marking. Marking steps are posted as regular tasks which the `AsyncEntry`
+	// loop picks up, so real work which arrives in the meantime is interleaved with the collection.
+	isolate->MemoryPressureNotification(MemoryPressureLevel::kModerate);
 }
 
 template <std::queue<std::unique_ptr<Runnable>> Scheduler::*Tasks>
@@ -342,6 +590,7 @@ void IsolateEnvironment::InterruptEntrySync() {
 
 IsolateEnvironment::IsolateEnvironment() :
 	owned_isolates{std::make_unique<OwnedIsolates>()},
+	pending_isolates{std::make_unique<PendingIsolates>(0U)},
 	scheduler{in_place<UvScheduler>{}, *this},
 	executor{*this},
 	nodejs_isolate{true} {}
@@ -356,10 +605,13 @@ void IsolateEnvironment::IsolateCtor(Isolate* isolate, Local<Context> context) {
 	default_context.Reset(isolate, context);
 }
 
-void IsolateEnvironment::IsolateCtor(size_t memory_limit_in_mb, shared_ptr<v8::BackingStore> snapshot_blob, size_t snapshot_length) {
+void IsolateEnvironment::IsolateCtor(CreateParams params) {
+	create_params = params;
+	size_t memory_limit_in_mb = params.memory_limit_in_mb;
 	memory_limit = memory_limit_in_mb * 1024 * 1024;
 	allocator_ptr = std::make_shared<LimitedAllocator>(*this, memory_limit);
-	snapshot_blob_ptr = std::move(snapshot_blob);
+	snapshot_blob_ptr = std::move(params.snapshot_blob);
+	workload = std::move(params.workload);
 
 	// Calculate resource constraints
 	ResourceConstraints rc;
@@ -369,6 +621,28 @@ void IsolateEnvironment::IsolateCtor(size_t memory_limit_in_mb, shared_ptr<v8::B
 	rc.set_max_young_generation_size_in_bytes(young_space_in_kb * 1024);
 	rc.set_max_old_generation_size_in_bytes(old_generation_size_in_mb * 1024 * 1024);
 
+	// Initial sizes are explicit, or borrowed from previous isolates of the same workload
+	size_t initial_old_generation_size = params.initial_old_generation_size_in_mb * 1024 * 1024;
+	size_t initial_young_generation_size = params.initial_young_generation_size_in_mb * 1024 * 1024;
+	if (!workload.empty()) {
+		auto profiles = workload_profiles.read();
+		auto it = profiles->find(workload);
+		if (it != profiles->end()) {
+			if (initial_old_generation_size == 0) {
+				initial_old_generation_size = it->second.old_generation_size;
+			}
+			if (initial_young_generation_size == 0) {
+				initial_young_generation_size = it->second.young_generation_size;
+			}
+		}
+	}
+	if (initial_old_generation_size != 0) {
+		rc.set_initial_old_generation_size_in_bytes(std::min(initial_old_generation_size, memory_limit));
+	}
+	if (initial_young_generation_size != 0) {
+		rc.set_initial_young_generation_size_in_bytes(std::min(initial_young_generation_size, young_space_in_kb * 1024));
+	}
+
 	// Build isolate from create params
 	Isolate::CreateParams create_params;
 	create_params.constraints = rc;
@@ -376,14 +650,17 @@ void IsolateEnvironment::IsolateCtor(size_t memory_limit_in_mb, shared_ptr<v8::B
 	if (snapshot_blob_ptr) {
 		create_params.snapshot_blob = &startup_data;
 		startup_data.data = reinterpret_cast<char*>(snapshot_blob_ptr->Data());
-		startup_data.raw_size = snapshot_length;
+		startup_data.raw_size = params.snapshot_length;
 	}
-	task_runner = std::make_shared<IsolateTaskRunner>(holder.lock()->GetIsolate());
+	task_runner = std::make_shared<IsolateTaskRunner>(shared_from_this());
+	isolate = Isolate::Allocate();
 	{
-		std::lock_guard allocator_lock{isolate_allocator_mutex};
-		isolate = Isolate::Allocate();
-		PlatformDelegate::RegisterIsolate(isolate, &*scheduler);
+		auto lock = disposing_isolates.read<true>();
+		while (lock->count(isolate) != 0) {
+			lock.wait();
+		}
 	}
+	PlatformDelegate::RegisterIsolate(isolate, &*scheduler);
 	Isolate::Initialize(isolate, create_params);
 
 	// Various callbacks
@@ -393,6 +670,7 @@ void IsolateEnvironment::IsolateCtor(size_t memory_limit_in_mb, shared_ptr<v8::B
 
 	// Add GC callbacks
 	isolate->AddGCEpilogueCallback(MarkSweepCompactEpilogue, static_cast<void*>(this), GCType::kGCTypeMarkSweepCompact);
+	isolate->AddGCEpilogueCallback(PublishStatsEpilogue, static_cast<void*>(this), GCType::kGCTypeAll);
 	isolate->AddNearHeapLimitCallback(NearHeapLimitCallback, static_cast<void*>(this));
 
 	// Heap statistics crushes down lots of different memory spaces into a single number. We note the
@@ -407,7 +685,16 @@ void IsolateEnvironment::IsolateCtor(size_t memory_limit_in_mb, shared_ptr<v8::B
 		Locker locker(isolate);
 		Isolate::Scope iso_scope(isolate);
 		HandleScope handle_scope(isolate);
-		default_context.Reset(isolate, NewContext());
+		if (snapshot_blob_ptr) {
+			Local<Integer> count;
+			if (isolate->GetDataFromSnapshotOnce<Integer>(0).ToLocal(&count)) {
+				snapshot_context_count = count->Value();
+			}
+		}
+		if (!params.lazy_default_context) {
+			default_context.Reset(isolate, NewContext());
+		}
+		PublishStats();
 	}
 
 	// There is no asynchronous Isolate ctor so we should throw away thread specifics in case
@@ -415,11 +702,110 @@ void IsolateEnvironment::IsolateCtor(size_t memory_limit_in_mb, shared_ptr<v8::B
 	isolate->DiscardThreadSpecificMetadata();
 
 	// Save reference to this isolate in the default isolate
-	Executor::GetDefaultEnvironment().owned_isolates->write()->insert({ dispose_wait, holder });
+	executor.default_executor.env.owned_isolates->write()->insert({ dispose_wait, holder });
+}
+
+void IsolateEnvironment::Reap(std::shared_ptr<IsolateEnvironment> env) {
+	if (env->nodejs_isolate) {
+		// Queued isolates may still be holding a reference to this one
+		reaper->Drain();
+	} else if (Executor::IsDefaultThread()) {
+		// Only the default thread can take a new uv ref. When the default isolate itself is being torn
+		// down its holder is already empty, and the isolate is disposed here instead.
+		auto default_holder = Executor::GetDefaultEnvironment().holder.lock();
+		if (default_holder && default_holder->GetIsolate()) {
+			LockedScheduler::IncrementUvRefForIsolate(default_holder);
+			reaper->Push(std::move(env), std::move(default_holder));
+			return;
+		}
+	}
+	env.reset();
+}
+
+void IsolateEnvironment::Hibernate(IsolateHolder& holder, std::function<void(IsolateEnvironment&)> revive_callback) {
+	// This runs inside the isolate, so nothing else is running and handle tasks queued by released
+	// references have already been accounted for in `remotes_count`. Tasks queued behind this one
+	// still run against the old heap before it's torn down.
+	auto env = *holder.isolate.read();
+	if (!env) {
+		throw RuntimeGenericError("Isolate is disposed");
+	} else if (env->nodejs_isolate) {
+		throw RuntimeGenericError("The default isolate can't hibernate");
+	} else if (env->inspector_agent) {
+		throw RuntimeGenericError("Isolates with an inspector can't hibernate");
+	} else if (!env->module_registry.empty()) {
+		throw RuntimeGenericError("Isolate has registered modules, unregister them first");
+	} else if (env->GetRemotesCount() != 0) {
+		throw RuntimeGenericError("Isolate has outstanding references");
+	}
+
+	// Everything needed to rebuild the isolate moves to an environment which hasn't been built yet.
+	// Configuration which lives outside of the heap goes along with it.
+	auto next = std::make_shared<IsolateEnvironment>(static_cast<UvScheduler&>(*env->executor.default_executor.env.scheduler));
+	next->holder = env->holder;
+	next->create_params = env->create_params;
+	next->revive_callback = std::move(revive_callback);
+	next->error_handler = std::move(env->error_handler);
+	next->soft_memory_limit_handler = std::move(env->soft_memory_limit_handler);
+	next->soft_memory_limit = env->soft_memory_limit;
+	next->memory_group = std::move(env->memory_group);
+	next->idle_collection_delay = env->idle_collection_delay;
+	next->context_pool_size = env->context_pool_size.load();
+	next->eval_cache_size = env->eval_cache_size;
+	next->stats_snapshot.write(env->GetStatsSnapshot());
+	// The old environment is torn down once the current task lets go of it
+	std::lock_guard lock{holder.hibernation_mutex};
+	holder.hibernation = std::move(next);
+	holder.hibernating = true;
+	holder.isolate.write()->reset();
+}
+
+void IsolateEnvironment::Revive() {
+	IsolateCtor(create_params);
+	if (revive_callback) {
+		revive_callback(*this);
+	}
+}
+
+void IsolateEnvironment::NewInBackground(CreateParams params, std::function<void(std::shared_ptr<IsolateHolder>)> callback) {
+	struct Construction {
+		std::shared_ptr<IsolateEnvironment> env;
+		std::shared_ptr<IsolateHolder> holder;
+		CreateParams params;
+		std::function<void(std::shared_ptr<IsolateHolder>)> callback;
+	};
+	// The environment itself must be constructed here since `Executor` finds the default isolate
+	// through a thread local
+	auto& default_env = Executor::GetDefaultEnvironment();
+	auto env = std::make_shared<IsolateEnvironment>(static_cast<UvScheduler&>(*default_env.scheduler));
+	auto holder = std::make_shared<IsolateHolder>(env);
+	env->holder = holder;
+	++*default_env.pending_isolates->write();
+	auto* construction = new Construction{std::move(env), std::move(holder), std::move(params), std::move(callback)};
+	construction_threads.exec(construction_affinity, [](bool /*pool_thread*/, void* param) {
+		std::unique_ptr<Construction> construction{static_cast<Construction*>(param)};
+		auto& default_env = construction->env->executor.default_executor.env;
+		construction->env->IsolateCtor(std::move(construction->params));
+		construction->env.reset();
+		construction->callback(std::move(construction->holder));
+		construction.reset();
+		--*default_env.pending_isolates->write();
+		default_env.pending_isolates->notify_all();
+	}, construction);
 }
 
 IsolateEnvironment::~IsolateEnvironment() {
-	if (nodejs_isolate) {
+	if (isolate == nullptr) {
+		// Hibernating isolate which was never rebuilt
+	} else if (nodejs_isolate) {
+		memory_governor.reset();
+		// Wait for isolates which are still being built
+		{
+			auto lock = pending_isolates->read<true>();
+			while (*lock != 0) {
+				lock.wait();
+			}
+		}
 		// Throw away all owned isolates when the root one dies
 		auto isolates = *owned_isolates->read(); // copy
 		for (const auto& handle : isolates) {
@@ -441,6 +827,9 @@ IsolateEnvironment::~IsolateEnvironment() {
 			// Now activate executor lock and invoke inspector agent's dtor
 			Executor::Lock lock{*this};
 			agent_ptr.reset();
+			if (!workload.empty()) {
+				RecordWorkloadProfile();
+			}
 			// Kill all weak persistents
 			for (auto it = weak_persistents.begin(); it != weak_persistents.end(); ) {
 				void(*fn)(void*) = it->second.first;
@@ -450,31 +839,61 @@ IsolateEnvironment::~IsolateEnvironment() {
 			}
 			assert(weak_persistents.empty());
 			unhandled_promise_rejections.clear();
+			spare_contexts.clear();
+			eval_cache.reset();
+			module_registry.clear();
+			parked_tasks.clear();
 			// Destroy outstanding tasks. Do this here while the executor lock is up.
 			auto scheduler_lock = scheduler->Lock();
 			ExchangeDefault(scheduler_lock->interrupts);
 			ExchangeDefault(scheduler_lock->sync_interrupts);
 			ExchangeDefault(scheduler_lock->handle_tasks);
 			ExchangeDefault(scheduler_lock->tasks);
+			ExchangeDefault(scheduler_lock->idle_tasks);
 		}
+		disposing_isolates.write()->insert(isolate);
 		{
-			std::lock_guard allocator_lock{isolate_allocator_mutex};
-			{
-				// Dispose() will call destructors for external strings and array buffers, so this lock sets the
-				// "current" isolate for those C++ dtors to function correctly without locking v8
-				Executor::Scope lock{*this};
-				isolate->Dispose();
-			}
-			// Unregister from Platform
-			PlatformDelegate::UnregisterIsolate(isolate);
+			// Dispose() will call destructors for external strings and array buffers, so this lock sets the
+			// "current" isolate for those C++ dtors to function correctly without locking v8
+			Executor::Scope lock{*this};
+			isolate->Dispose();
 		}
+		// Unregister from Platform
+		PlatformDelegate::UnregisterIsolate(isolate);
+		disposing_isolates.write()->erase(isolate);
+		disposing_isolates.notify_all();
 		// Unreference from default isolate
 		executor.default_executor.env.owned_isolates->write()->erase({ dispose_wait, holder });
+		// Give the budget back before anyone waiting on `dispose_wait` is told we're done
+		memory_group.reset();
 	}
 	// Send notification that this isolate is totally disposed
 	dispose_wait->IsolateDidDispose();
 }
 
+void IsolateEnvironment::RecordWorkloadProfile() {
+	HeapStatistics heap;
+	isolate->GetHeapStatistics(&heap);
+	WorkloadProfile sample;
+	sample.old_generation_size = std::max(peak_used_heap_size, heap.used_heap_size());
+	HeapSpaceStatistics space;
+	for (size_t ii = 0; ii < isolate->NumberOfHeapSpaces(); ++ii) {
+		isolate->GetHeapSpaceStatistics(&space, ii);
+		if (std::strcmp(space.space_name(), "new_space") == 0) {
+			sample.young_generation_size = space.space_size();
+		}
+	}
+	// Grow immediately to a larger sample, but decay slowly so a single small run doesn't undo
+	// everything we've learned about this workload.
+	auto blend = [](size_t previous, size_t sample) {
+		return std::max(sample, (previous * 3 + sample) / 4);
+	};
+	auto profiles = workload_profiles.write();
+	auto& profile = (*profiles)[workload];
+	profile.old_generation_size = blend(profile.old_generation_size, sample.old_generation_size);
+	profile.young_generation_size = blend(profile.young_generation_size, sample.young_generation_size);
+}
+
 static void DeserializeInternalFieldsCallback(Local<Object> /*holder*/, int /*index*/, StartupData /*payload*/, void* /*data*/) {
 }
 
@@ -488,9 +907,25 @@ auto IsolateEnvironment::NewContext() -> Local<Context> {
 	return context;
 }
 
+auto IsolateEnvironment::NewContextFromSnapshot(size_t index) -> Local<Context> {
+	// v8 crashes if the index is out of range so it must be checked here
+	if (index >= snapshot_context_count) {
+		throw RuntimeRangeError("`snapshotIndex` is out of range for this isolate's snapshot");
+	}
+	auto context = Unmaybe(Context::FromSnapshot(isolate, index, &DeserializeInternalFieldsCallback));
+	context->AllowCodeGenerationFromStrings(false);
+	return context;
+}
+
 auto IsolateEnvironment::TaskEpilogue() -> std::unique_ptr<ExternalCopy> {
 	isolate->PerformMicrotaskCheckpoint();
 	CheckMemoryPressure();
+	PublishStats();
+	if (idle_collection_delay != 0) {
+		// Sync tasks don't go through `ScheduleTask` so the epoch is also bumped here
+		++task_epoch;
+		ScheduleIdleCollection();
+	}
 	if (hit_memory_limit) {
 		throw FatalRuntimeError("Isolate was disposed during execution due to memory limit");
 	}
@@ -504,6 +939,109 @@ auto IsolateEnvironment::TaskEpilogue() -> std::unique_ptr<ExternalCopy> {
 	return {};
 }
 
+void IsolateEnvironment::SetMemoryGovernor(std::unique_ptr<MemoryGovernor> governor) {
+	assert(nodejs_isolate);
+	memory_governor = std::move(governor);
+}
+
+void IsolateEnvironment::TrimMemory() {
+	// Spare contexts and compiled eval code will be rebuilt as they're needed
+	spare_contexts.clear();
+	if (eval_cache) {
+		eval_cache->Clear();
+	}
+	isolate->LowMemoryNotification();
+}
+
+void IsolateEnvironment::SetEvalCacheSize(size_t size) {
+	eval_cache_size = size;
+}
+
+auto IsolateEnvironment::GetEvalCache() -> EvalCache* {
+	if (!eval_cache && eval_cache_size != 0) {
+		eval_cache = std::make_unique<EvalCache>(eval_cache_size);
+	}
+	return eval_cache.get();
+}
+
+void IsolateEnvironment::SetContextPoolSize(size_t size) {
+	context_pool_size = size;
+	if (size != 0) {
+		ScheduleContextPoolRefill();
+	}
+}
+
+auto IsolateEnvironment::TakeSpareContext() -> Local<Context> {
+	if (context_pool_size == 0) {
+		return {};
+	}
+	ScheduleContextPoolRefill();
+	if (spare_contexts.empty()) {
+		return {};
+	}
+	auto context = spare_contexts.front().Get(isolate);
+	spare_contexts.pop_front();
+	return context;
+}
+
+void IsolateEnvironment::ScheduleContextPoolRefill() {
+	class RefillContextPoolTask : public Runnable {
+		public:
+			void Run() final {
+				IsolateEnvironment::GetCurrent().RefillContextPool();
+			}
+	};
+	if (!context_pool_refill_scheduled.exchange(true)) {
+		if (!ScheduleOwnTask(std::make_unique<RefillContextPoolTask>())) {
+			context_pool_refill_scheduled = false;
+		}
+	}
+}
+
+void IsolateEnvironment::RefillContextPool() {
+	context_pool_refill_scheduled = false;
+	HandleScope handle_scope{isolate};
+	// Spare contexts count against the memory limit like any other allocation
+	HeapCheck heap_check{*this, true};
+	try {
+		while (spare_contexts.size() < context_pool_size && !terminated) {
+			spare_contexts.emplace_back(isolate, NewContext());
+		}
+		heap_check.Epilogue();
+	} catch (const RuntimeError& cc_error) {
+		// The isolate was terminated for going over its limit, nobody is waiting on this task
+	}
+}
+
+auto IsolateEnvironment::ScheduleOwnTask(std::unique_ptr<Runnable> task) -> bool {
+	// Only schedule against this environment. If it's hibernating the holder would otherwise build a
+	// new isolate, just to run housekeeping meant for the old one.
+	auto holder = this->holder.lock();
+	auto env = holder ? holder->GetIsolateIfAwake() : nullptr;
+	if (env.get() != this) {
+		return false;
+	}
+	holder->ScheduleTask(std::move(task), false, true);
+	return true;
+}
+
+void IsolateEnvironment::ContextDisposed() {
+	class ContextDisposedTask : public Runnable {
+		public:
+			void Run() final {
+				auto& env = IsolateEnvironment::GetCurrent();
+				env.disposed_contexts = 0;
+				env->ContextDisposedNotification();
+			}
+	};
+	if (disposed_contexts++ == 0) {
+		if (!ScheduleOwnTask(std::make_unique<ContextDisposedTask>())) {
+			// The notification will never run, so the next disposal has to try again
+			disposed_contexts = 0;
+		}
+	}
+}
+
 auto IsolateEnvironment::GetLimitedAllocator() const -> LimitedAllocator* {
 	if (nodejs_isolate) {
 		return nullptr;
@@ -6,6 +6,7 @@
 
 #include "executor.h"
 #include "holder.h"
+#include "memory_group.h"
 #include "remote_handle.h"
 #include "runnable.h"
 #include "scheduler.h"
@@ -14,6 +15,7 @@
 #include "cpu_profile_manager.h"
 #include "lib/covariant.h"
 #include "lib/lockable.h"
+#include "lib/seqlock.h"
 #include "lib/thread_pool.h"
 #include "v8-profiler.h"
 
@@ -45,6 +47,7 @@ class IsolateEnvironment : public std::enable_shared_from_this<IsolateEnvironmen
 	friend class IsolateHolder;
 	friend class LimitedAllocator;
 	friend class LockedScheduler;
+	friend class MemoryGovernor;
 	friend StringTable;
 	friend class ThreePhaseTask;
 	template <class>
@@ -53,6 +56,47 @@ class IsolateEnvironment : public std::enable_shared_from_this<IsolateEnvironmen
 	friend auto RunWithTimeout(uint32_t timeout_ms, F&& fn) -> v8::Local<v8::Value>;
 
 	public:
+		/**
+		 * Statistics published by the isolate at each GC and task boundary. These can be read from any
+		 * thread without waiting on the isolate.
+		 */
+		struct StatsSnapshot {
+			size_t total_heap_size = 0;
+			size_t total_heap_size_executable = 0;
+			size_t total_physical_size = 0;
+			size_t total_available_size = 0;
+			size_t used_heap_size = 0;
+			size_t heap_size_limit = 0;
+			size_t malloced_memory = 0;
+			size_t peak_malloced_memory = 0;
+			size_t externally_allocated_size = 0;
+			size_t number_of_native_contexts = 0;
+			size_t number_of_detached_contexts = 0;
+			std::chrono::nanoseconds cpu_time{};
+			std::chrono::nanoseconds wall_time{};
+			size_t queue_depth = 0;
+			size_t eval_cache_hits = 0;
+			size_t eval_cache_misses = 0;
+			// Milliseconds since epoch
+			double timestamp = 0;
+		};
+
+		/**
+		 * Parameters used to construct a new isolate. Sizes are in MB.
+		 */
+		struct CreateParams {
+			size_t memory_limit_in_mb = 128;
+			std::shared_ptr<v8::BackingStore> snapshot_blob;
+			size_t snapshot_length = 0;
+			size_t initial_old_generation_size_in_mb = 0;
+			size_t initial_young_generation_size_in_mb = 0;
+			// Isolates which share a workload name are pre-sized based on previous isolates of the same
+			// workload
+			std::string workload;
+			// Don't build the internal default context until something needs it
+			bool lazy_default_context = false;
+		};
+
 		/**
 		 * Ensures we don't blow up the v8 heap while transferring arbitrary data
 		 */
@@ -83,8 +127,15 @@ class IsolateEnvironment : public std::enable_shared_from_this<IsolateEnvironmen
 		// Another good candidate for std::optional<> (because this is only used by the root isolate)
 		using OwnedIsolates = lockable_t<std::set<ReleaseAndJoinHandle>, true>;
 		std::unique_ptr<OwnedIsolates> owned_isolates;
+		// Number of isolates being built on background threads which aren't yet in `owned_isolates`
+		using PendingIsolates = lockable_t<unsigned, false, true>;
+		std::unique_ptr<PendingIsolates> pending_isolates;
+		std::unique_ptr<class MemoryGovernor> memory_governor;
 
 		v8::Isolate* isolate{};
+		// Kept so the isolate can be rebuilt after `Hibernate`
+		CreateParams create_params;
+		std::function<void(IsolateEnvironment&)> revive_callback;
 		covariant_t<LockedScheduler, IsolatedScheduler, UvScheduler> scheduler;
 		Executor executor;
 		std::shared_ptr<IsolateDisposeWait> dispose_wait{std::make_shared<IsolateDisposeWait>()};
@@ -92,6 +143,17 @@ class IsolateEnvironment : public std::enable_shared_from_this<IsolateEnvironmen
 		std::shared_ptr<IsolateTaskRunner> task_runner;
 		std::unique_ptr<class InspectorAgent> inspector_agent;
 		v8::Persistent<v8::Context> default_context;
+		// Number of extra contexts in the snapshot, see `createSnapshot`
+		size_t snapshot_context_count = 0;
+		// Fresh contexts built ahead of time for `createContext`
+		std::deque<v8::Global<v8::Context>> spare_contexts;
+		std::atomic<size_t> context_pool_size{0};
+		std::atomic<bool> context_pool_refill_scheduled{false};
+		// Compiled `eval` and `evalClosure` code, built when first needed
+		std::unique_ptr<class EvalCache> eval_cache;
+		size_t eval_cache_size = 0;
+		// Contexts released since the last `ContextDisposedNotification`
+		unsigned disposed_contexts = 0;
 		std::shared_ptr<v8::ArrayBuffer::Allocator> allocator_ptr;
 		std::shared_ptr<v8::BackingStore> snapshot_blob_ptr;
 		v8::StartupData startup_data{};
@@ -99,14 +161,35 @@ class IsolateEnvironment : public std::enable_shared_from_this<IsolateEnvironmen
 		size_t memory_limit = 0;
 		size_t initial_heap_size_limit = 0;
 		size_t misc_memory_size = 0;
+		size_t soft_memory_limit = 0;
 		std::atomic<size_t> extra_allocated_memory = 0;
+		std::unique_ptr<MemoryGroup::Member> memory_group;
 		v8::MemoryPressureLevel memory_pressure = v8::MemoryPressureLevel::kNone;
 		v8::MemoryPressureLevel last_memory_pressure = v8::MemoryPressureLevel::kNone;
 		bool hit_memory_limit = false;
 		bool did_adjust_heap_limit = false;
+		bool did_hit_soft_memory_limit = false;
 		bool nodejs_isolate = false;
 		std::atomic<unsigned int> remotes_count{0};
+		uint32_t idle_collection_delay = 0;
+		// Incremented each time work is scheduled. Idle collections only happen if this hasn't changed
+		// since the isolate went idle.
+		std::atomic<unsigned> task_epoch{0};
+		unsigned idle_collection_epoch = 0;
+		// Each isolate has at most one idle timer in flight. New work just pushes the deadline back and
+		// the timer re-arms itself for the remainder when it fires early.
+		struct IdleTimer {
+			uint64_t deadline = 0;
+			unsigned epoch = 0;
+			bool armed = false;
+		};
+		lockable_t<IdleTimer> idle_timer;
 		v8::HeapStatistics last_heap {};
+		std::string workload;
+		size_t peak_used_heap_size = 0;
+		// Tasks in the current batch which haven't run yet
+		size_t queue_depth = 0;
+		seqlock_t<StatsSnapshot> stats_snapshot;
 		// Copyable traits used to opt into destructor handle reset
 		std::deque<v8::Global<v8::Promise>> unhandled_promise_rejections;
 		StringTable string_table;
@@ -114,10 +197,14 @@ class IsolateEnvironment : public std::enable_shared_from_this<IsolateEnvironmen
 		std::vector<v8::Eternal<v8::Data>> specifics;
 		std::unordered_map<v8::Persistent<v8::Value>*, std::pair<void(*)(void*), void*>> weak_persistents;
 		std::shared_ptr<CpuProfileManager> cpu_profile_manager;
+		// Async tasks waiting on something inside this isolate, see `ThreePhaseTask::DeferUntilResumed`
+		std::unordered_map<class ThreePhaseTask*, std::unique_ptr<Runnable>> parked_tasks;
 
 	public:
 		RemoteHandle<v8::Function> error_handler;
+		RemoteHandle<v8::Function> soft_memory_limit_handler;
 		std::unordered_multimap<int, struct ModuleInfo*> module_handles;
+		std::unordered_map<std::string, std::shared_ptr<struct ModuleInfo>> module_registry;
 		std::unordered_map<class NativeModule*, std::shared_ptr<NativeModule>> native_modules;
 		int terminate_depth = 0;
 		std::atomic<bool> terminated { false };
@@ -150,10 +237,47 @@ class IsolateEnvironment : public std::enable_shared_from_this<IsolateEnvironmen
 		 * GC hooks to kill this isolate before it runs out of memory
 		 */
 		static void MarkSweepCompactEpilogue(v8::Isolate* isolate, v8::GCType gc_type, v8::GCCallbackFlags gc_flags, void* data);
+		static void PublishStatsEpilogue(v8::Isolate* isolate, v8::GCType gc_type, v8::GCCallbackFlags gc_flags, void* data);
 		static auto NearHeapLimitCallback(void* data, size_t current_heap_limit, size_t initial_heap_limit) -> size_t;
 		void RequestMemoryPressureNotification(v8::MemoryPressureLevel memory_pressure, bool as_interrupt = false);
 		static void MemoryPressureInterrupt(v8::Isolate* isolate, void* data);
 		void CheckMemoryPressure();
+		void NotifySoftMemoryLimit(size_t total_memory);
+
+		/**
+		 * Writes current statistics to `stats_snapshot`
+		 */
+		void PublishStats();
+
+		/**
+		 * Idle-time garbage collection
+		 */
+		void ScheduleIdleCollection();
+		void ArmIdleTimer(uint64_t delay_ns);
+		void IdleTimerFired();
+		void RunIdleCollection();
+
+		/**
+		 * Schedules a task on this environment. Returns false if it's disposed or hibernating, in which
+		 * case the task is dropped.
+		 */
+		auto ScheduleOwnTask(std::unique_ptr<Runnable> task) -> bool;
+
+		/**
+		 * Schedules a task to top up `spare_contexts`
+		 */
+		void ScheduleContextPoolRefill();
+		void RefillContextPool();
+
+		/**
+		 * Shared budget checks. These always pass for isolates which don't belong to a group.
+		 */
+		auto ChargeMemoryGroup(size_t usage) -> bool {
+			return !memory_group || memory_group->Charge(usage);
+		}
+		auto FitsMemoryGroup(size_t usage) const -> bool {
+			return !memory_group || memory_group->Fits(usage);
+		}
 
 		/**
 		 * Wrap an existing Isolate. This should only be called for the main node Isolate.
@@ -163,7 +287,12 @@ class IsolateEnvironment : public std::enable_shared_from_this<IsolateEnvironmen
 		/**
 		 * Create a new wrapped Isolate.
 		 */
-		void IsolateCtor(size_t memory_limit_in_mb, std::shared_ptr<v8::BackingStore> snapshot_blob, size_t snapshot_length);
+		void IsolateCtor(CreateParams params);
+
+		/**
+		 * Saves heap usage of this isolate to its workload profile
+		 */
+		void RecordWorkloadProfile();
 
 	public:
 		/**
@@ -186,14 +315,39 @@ class IsolateEnvironment : public std::enable_shared_from_this<IsolateEnvironmen
 			return holder;
 		}
 
-		static auto New(size_t memory_limit_in_mb, std::shared_ptr<v8::BackingStore> snapshot_blob, size_t snapshot_length) -> std::shared_ptr<IsolateHolder> {
+		static auto New(CreateParams params) -> std::shared_ptr<IsolateHolder> {
 			auto env = std::make_shared<IsolateEnvironment>(static_cast<UvScheduler&>(*Executor::GetDefaultEnvironment().scheduler));
 			auto holder = std::make_shared<IsolateHolder>(env);
 			env->holder = holder;
-			env->IsolateCtor(memory_limit_in_mb, std::move(snapshot_blob), snapshot_length);
+			env->IsolateCtor(std::move(params));
 			return holder;
 		}
 
+		/**
+		 * Same as `New` except the isolate is built on a background thread. `callback` is invoked on that
+		 * thread once the isolate is ready.
+		 */
+		static void NewInBackground(CreateParams params, std::function<void(std::shared_ptr<IsolateHolder>)> callback);
+
+		/**
+		 * Drops a reference to a disposed isolate. On the default thread the reference is handed to a
+		 * background thread, so if it's the last one the cost of tearing down the heap isn't paid here.
+		 */
+		static void Reap(std::shared_ptr<IsolateEnvironment> env);
+
+		/**
+		 * Throws away the v8 heap of an idle isolate. This must be called from within the isolate. The
+		 * holder stays valid and the next time the isolate is needed it's rebuilt from its original
+		 * parameters (and snapshot), after which `revive_callback` is invoked on the new environment.
+		 * Throws if the isolate has outstanding references.
+		 */
+		static void Hibernate(IsolateHolder& holder, std::function<void(IsolateEnvironment&)> revive_callback);
+
+	private:
+		void Revive();
+
+	public:
+
 		/**
 		 * Return pointer the currently running IsolateEnvironment
 		 */
@@ -235,9 +389,13 @@ class IsolateEnvironment : public std::enable_shared_from_this<IsolateEnvironmen
 		}
 
 		/**
-		 * Default context, useful for generating certain objects when we aren't in a context.
+		 * Default context, useful for generating certain objects when we aren't in a context. If the
+		 * isolate was created with `lazy_default_context` this builds it on first use.
 		 */
-		auto DefaultContext() const -> v8::Local<v8::Context> {
+		auto DefaultContext() -> v8::Local<v8::Context> {
+			if (default_context.IsEmpty()) {
+				default_context.Reset(isolate, NewContext());
+			}
 			return v8::Local<v8::Context>::New(isolate, default_context);
 		}
 
@@ -246,6 +404,11 @@ class IsolateEnvironment : public std::enable_shared_from_this<IsolateEnvironmen
 		 */
 		auto NewContext() -> v8::Local<v8::Context>;
 
+		/**
+		 * Restores one of the extra contexts embedded in this isolate's snapshot
+		 */
+		auto NewContextFromSnapshot(size_t index) -> v8::Local<v8::Context>;
+
 		/**
 		 * Called by Scheduler when there is work to be done in this isolate.
 		 */
@@ -292,6 +455,71 @@ class IsolateEnvironment : public std::enable_shared_from_this<IsolateEnvironmen
 			return dispose_wait;
 		}
 
+		/**
+		 * Sets the soft memory limit, in bytes. When a full GC finishes above this threshold the isolate
+		 * will attempt to collect harder, and then notify `soft_memory_limit_handler` if that fails.
+		 */
+		void SetSoftMemoryLimit(size_t limit) {
+			soft_memory_limit = limit;
+		}
+
+		/**
+		 * Joins a shared memory budget. `memory_limit` continues to act as a ceiling for this isolate.
+		 */
+		void SetMemoryGroup(std::unique_ptr<MemoryGroup::Member> member) {
+			memory_group = std::move(member);
+		}
+
+		/**
+		 * Number of spare contexts to keep built ahead of time. Taking a spare context schedules a task
+		 * to build its replacement.
+		 */
+		void SetContextPoolSize(size_t size);
+		auto TakeSpareContext() -> v8::Local<v8::Context>;
+
+		/**
+		 * Maximum number of compiled scripts to keep for `eval` and `evalClosure`. `GetEvalCache` returns
+		 * nullptr while this is 0, which is the default.
+		 */
+		void SetEvalCacheSize(size_t size);
+		auto GetEvalCache() -> EvalCache*;
+
+		/**
+		 * Called when a context is released. `ContextDisposedNotification` is sent once for every batch
+		 * of released contexts instead of once for each.
+		 */
+		void ContextDisposed();
+
+		/**
+		 * Number of milliseconds this isolate must be idle before v8 idle tasks and garbage collection
+		 * are run. 0 disables idle collection.
+		 */
+		auto GetIdleCollectionDelay() const -> uint32_t {
+			return idle_collection_delay;
+		}
+		void SetIdleCollectionDelay(uint32_t delay) {
+			idle_collection_delay = delay;
+		}
+
+		/**
+		 * Invoked on the default thread after the idle delay expires. Does nothing if more work was
+		 * scheduled since the isolate went idle.
+		 */
+		void WakeForIdleCollection(unsigned epoch);
+
+		/**
+		 * Replaces the process-wide memory governor. Only valid on the default isolate.
+		 */
+		void SetMemoryGovernor(std::unique_ptr<MemoryGovernor> governor);
+
+		/**
+		 * Invoked by MemoryGovernor in each isolate when process-wide memory runs low
+		 */
+		void ApplyMemoryPressure(v8::MemoryPressureLevel level) {
+			RequestMemoryPressureNotification(level);
+		}
+		void TrimMemory();
+
 		/**
 		 * Check memory limit flag
 		 */
@@ -334,6 +562,13 @@ class IsolateEnvironment : public std::enable_shared_from_this<IsolateEnvironmen
 		auto GetCpuTime() -> std::chrono::nanoseconds;
 		auto GetWallTime() -> std::chrono::nanoseconds;
 
+		/**
+		 * Returns the most recently published statistics. This is safe to call from any thread.
+		 */
+		auto GetStatsSnapshot() const -> StatsSnapshot {
+			return stats_snapshot.read();
+		}
+
 		/**
 	     * CPU Profiler
 		 */
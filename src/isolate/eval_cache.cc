@@ -0,0 +1,35 @@
+#include "eval_cache.h"
+
+using namespace v8;
+
+namespace ivm {
+
+auto EvalCache::Lookup(const std::string& key) -> Local<UnboundScript> {
+	auto it = index.find(key);
+	if (it == index.end()) {
+		++misses;
+		return {};
+	}
+	++hits;
+	entries.splice(entries.begin(), entries, it->second);
+	return it->second->script.Get(Isolate::GetCurrent());
+}
+
+void EvalCache::Insert(std::string key, Local<UnboundScript> script) {
+	if (index.find(key) != index.end()) {
+		return;
+	}
+	entries.push_front({ std::move(key), Global<UnboundScript>{Isolate::GetCurrent(), script} });
+	index.emplace(entries.front().key, entries.begin());
+	if (entries.size() > max_entries) {
+		index.erase(entries.back().key);
+		entries.pop_back();
+	}
+}
+
+void EvalCache::Clear() {
+	index.clear();
+	entries.clear();
+}
+
+} // namespace ivm
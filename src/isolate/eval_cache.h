@@ -0,0 +1,44 @@
+#pragma once
+#include <v8.h>
+#include <cstddef>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace ivm {
+
+/**
+ * Per-isolate cache of scripts compiled by `eval` and `evalClosure`, so that running the same code
+ * again skips the parser. Entries are keyed by the exact source and origin, and the least recently
+ * used entry is evicted once there are more than `max_entries`. This must only be used while the
+ * isolate is locked.
+ */
+class EvalCache {
+	public:
+		explicit EvalCache(size_t max_entries) : max_entries{max_entries} {}
+
+		// Returns an empty handle on a miss
+		auto Lookup(const std::string& key) -> v8::Local<v8::UnboundScript>;
+		void Insert(std::string key, v8::Local<v8::UnboundScript> script);
+		// Drops every entry but keeps the hit and miss counts
+		void Clear();
+
+		auto GetHits() const { return hits; }
+		auto GetMisses() const { return misses; }
+
+	private:
+		struct Entry {
+			std::string key;
+			v8::Global<v8::UnboundScript> script;
+		};
+
+		// Most recently used first
+		std::list<Entry> entries;
+		std::unordered_map<std::string_view, std::list<Entry>::iterator> index;
+		size_t max_entries;
+		size_t hits = 0;
+		size_t misses = 0;
+};
+
+} // namespace ivm
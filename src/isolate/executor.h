@@ -177,7 +177,8 @@ inline auto Executor::GetDefaultEnvironment() -> IsolateEnvironment& {
 }
 
 inline auto Executor::IsDefaultThread() -> bool {
-	return std::this_thread::get_id() == current_executor->default_thread;
+	// Threads which have never entered an isolate have no executor
+	return current_executor != nullptr && std::this_thread::get_id() == current_executor->default_thread;
 };
 
 } // namespace ivm
@@ -30,10 +30,20 @@ inline void RunCallback(T& info, F fn) {
 	}
 }
 
-template <typename F1, typename F2>
-inline void RunCatchExternal(v8::Local<v8::Context> default_context, F1 fn1, F2 fn2) {
+inline auto ResolveContext(v8::Local<v8::Context> context) -> v8::Local<v8::Context> {
+	return context;
+}
+
+template <class Getter>
+auto ResolveContext(Getter& getter) -> v8::Local<v8::Context> {
+	return getter();
+}
+
+template <typename C, typename F1, typename F2>
+inline void RunCatchExternal(C default_context, F1 fn1, F2 fn2) {
 	// This function will call `fn1()` and if that fails it will convert the caught error to an
-	// `ExternalCopy` and call `fn2(err)`
+	// `ExternalCopy` and call `fn2(err)`. `default_context` is only needed in that case, so it may
+	// also be a function which returns the context.
 	auto* isolate = v8::Isolate::GetCurrent();
 	v8::TryCatch try_catch{isolate};
 	try {
@@ -51,7 +61,7 @@ inline void RunCatchExternal(v8::Local<v8::Context> default_context, F1 fn1, F2
 		} catch (const RuntimeError& cc_error) {
 			// If this is caught it means the error needs to be copied out of v8
 			assert(try_catch.HasCaught());
-			v8::Context::Scope context_scope{default_context};
+			v8::Context::Scope context_scope{ResolveContext(default_context)};
 			fn2(ExternalCopy::CopyThrownValue(try_catch.Exception()));
 		}
 	} catch (...) {
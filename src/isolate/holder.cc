@@ -8,17 +8,35 @@
 namespace ivm {
 
 void IsolateDisposeWait::IsolateDidDispose() {
-	*is_disposed.write() = true;
-	is_disposed.notify_all();
+	auto callbacks = [&]() {
+		auto lock = state.write();
+		lock->is_disposed = true;
+		return std::exchange(lock->callbacks, {});
+	}();
+	state.notify_all();
+	for (auto& callback : callbacks) {
+		callback();
+	}
 }
 
 void IsolateDisposeWait::Join() {
-	auto lock = is_disposed.read<true>();
-	while (!*lock) {
+	auto lock = state.read<true>();
+	while (!lock->is_disposed) {
 		lock.wait();
 	}
 }
 
+void IsolateDisposeWait::OnDispose(std::function<void()> callback) {
+	{
+		auto lock = state.write();
+		if (!lock->is_disposed) {
+			lock->callbacks.push_back(std::move(callback));
+			return;
+		}
+	}
+	callback();
+}
+
 auto IsolateHolder::GetCurrent() -> std::shared_ptr<IsolateHolder> {
 	return IsolateEnvironment::GetCurrentHolder();
 }
@@ -27,8 +45,15 @@ auto IsolateHolder::Dispose() -> bool {
 	auto ref = std::exchange(*isolate.write(), {});
 	if (ref) {
 		ref->Terminate();
-		ref.reset();
+		IsolateEnvironment::Reap(std::move(ref));
 		return true;
+	} else if (hibernating) {
+		auto ref = [&]() {
+			std::lock_guard lock{hibernation_mutex};
+			hibernating = false;
+			return std::exchange(hibernation, {});
+		}();
+		return ref != nullptr;
 	} else {
 		return false;
 	}
@@ -36,16 +61,63 @@ auto IsolateHolder::Dispose() -> bool {
 
 void IsolateHolder::Release() {
 	auto ref = std::exchange(*isolate.write(), {});
-	ref.reset();
+	if (ref) {
+		IsolateEnvironment::Reap(std::move(ref));
+	}
 }
 
 auto IsolateHolder::GetIsolate() -> std::shared_ptr<IsolateEnvironment> {
+	auto ref = *isolate.read();
+	if (ref || !hibernating) {
+		return ref;
+	}
+	return Revive();
+}
+
+auto IsolateHolder::GetIsolateIfAwake() -> std::shared_ptr<IsolateEnvironment> {
 	return *isolate.read();
 }
 
-void IsolateHolder::ScheduleTask(std::unique_ptr<Runnable> task, bool run_inline, bool wake_isolate, bool handle_task) {
+auto IsolateHolder::GetHibernation() -> std::shared_ptr<IsolateEnvironment> {
+	std::lock_guard lock{hibernation_mutex};
+	return hibernation;
+}
+
+auto IsolateHolder::GetDisposeWait() -> std::shared_ptr<IsolateDisposeWait> {
 	auto ref = *isolate.read();
 	if (ref) {
+		return ref->GetDisposeWaitHandle();
+	}
+	std::lock_guard lock{hibernation_mutex};
+	if (hibernation) {
+		return hibernation->GetDisposeWaitHandle();
+	}
+	// Revived or disposed since the first check
+	ref = *isolate.read();
+	return ref ? ref->GetDisposeWaitHandle() : nullptr;
+}
+
+auto IsolateHolder::IsDisposed() -> bool {
+	return !*isolate.read() && !hibernating;
+}
+
+auto IsolateHolder::Revive() -> std::shared_ptr<IsolateEnvironment> {
+	std::lock_guard lock{hibernation_mutex};
+	if (!hibernation) {
+		// Another thread got here first, or it was disposed
+		return *isolate.read();
+	}
+	auto ref = std::exchange(hibernation, {});
+	ref->Revive();
+	*isolate.write() = ref;
+	hibernating = false;
+	return ref;
+}
+
+void IsolateHolder::ScheduleTask(std::unique_ptr<Runnable> task, bool run_inline, bool wake_isolate, bool handle_task) {
+	auto ref = GetIsolate();
+	if (ref) {
+		++ref->task_epoch;
 		if (run_inline && Executor::MayRunInlineTasks(*ref)) {
 			task->Run();
 			return;
@@ -66,7 +138,15 @@ void IsolateHolder::ScheduleTask(std::unique_ptr<Runnable> task, bool run_inline
 void IsolateTaskRunner::PostTaskImpl(std::unique_ptr<v8::Task> task, const v8::SourceLocation& /*location*/) {
 	auto env = weak_env.lock();
 	if (env) {
-		env->GetScheduler().Lock()->tasks.push(std::move(task));
+		// These usually just run the next time the isolate is doing something. A parked task may be
+		// waiting on one though, for example v8 settling a WebAssembly compilation, and then the
+		// isolate needs to wake up. The parked task holds a uv ref on the default isolate which makes
+		// waking from this thread safe.
+		auto lock = env->GetScheduler().Lock();
+		lock->tasks.push(std::move(task));
+		if (lock->wake_on_posted_tasks != 0) {
+			lock->WakeIsolate(std::move(env));
+		}
 	}
 }
 
@@ -85,4 +165,17 @@ void IsolateTaskRunner::PostDelayedTaskImpl(std::unique_ptr<v8::Task> task, doub
 	});
 }
 
+void IsolateTaskRunner::PostIdleTaskImpl(std::unique_ptr<v8::IdleTask> task, const v8::SourceLocation& /*location*/) {
+	auto env = weak_env.lock();
+	if (env) {
+		// These run the next time the isolate goes idle, see `IsolateEnvironment::RunIdleCollection`
+		env->GetScheduler().Lock()->idle_tasks.push(std::move(task));
+	}
+}
+
+auto IsolateTaskRunner::IdleTasksEnabled() -> bool {
+	auto env = weak_env.lock();
+	return env && env->GetScheduler().IdleTasksEnabled();
+}
+
 } // namespace ivm
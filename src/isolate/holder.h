@@ -4,9 +4,12 @@
 #include "v8_version.h"
 #include "lib/lockable.h"
 #include <v8-platform.h>
+#include <atomic>
 #include <condition_variable>
+#include <functional>
 #include <mutex>
 #include <memory>
+#include <vector>
 
 namespace ivm {
 
@@ -16,9 +19,16 @@ class IsolateDisposeWait {
 	public:
 		void IsolateDidDispose();
 		void Join();
+		// Invokes `callback` once the isolate is disposed, which may be immediately. The callback may be
+		// invoked from any thread.
+		void OnDispose(std::function<void()> callback);
 
 	private:
-		lockable_t<bool, false, true> is_disposed{false};
+		struct State {
+			bool is_disposed = false;
+			std::vector<std::function<void()>> callbacks;
+		};
+		lockable_t<State, false, true> state;
 };
 
 class IsolateHolder {
@@ -35,11 +45,28 @@ class IsolateHolder {
 
 		auto Dispose() -> bool;
 		void Release();
+		// Returns the isolate, rebuilding it first if it's hibernating. nullptr means it's disposed.
 		auto GetIsolate() -> std::shared_ptr<IsolateEnvironment>;
+		// Returns the isolate without rebuilding it. nullptr means it's hibernating or disposed.
+		auto GetIsolateIfAwake() -> std::shared_ptr<IsolateEnvironment>;
+		// While hibernating, returns the environment waiting to be rebuilt. It has no v8 isolate but it
+		// does hold the statistics published before hibernation.
+		auto GetHibernation() -> std::shared_ptr<IsolateEnvironment>;
+		auto GetDisposeWait() -> std::shared_ptr<IsolateDisposeWait>;
+		auto IsDisposed() -> bool;
+		auto IsHibernating() const -> bool { return hibernating; }
 		void ScheduleTask(std::unique_ptr<Runnable> task, bool run_inline, bool wake_isolate, bool handle_task = false);
 
 	private:
+		auto Revive() -> std::shared_ptr<IsolateEnvironment>;
+
 		lockable_t<std::shared_ptr<IsolateEnvironment>> isolate;
+		// While hibernating this is an environment which has everything but a v8 isolate. It's built
+		// ahead of time because environments can only be constructed on isolate threads, but revival
+		// can happen anywhere.
+		std::mutex hibernation_mutex;
+		std::shared_ptr<IsolateEnvironment> hibernation;
+		std::atomic<bool> hibernating{false};
 };
 
 // This needs to be separate from IsolateHolder because v8 holds references to this indefinitely and
@@ -54,6 +81,8 @@ class IsolateTaskRunner final : public TaskRunner {
 		// Methods for v8::TaskRunner
 		void PostTaskImpl(std::unique_ptr<v8::Task> task, const v8::SourceLocation& /*location*/) final;
 		void PostDelayedTaskImpl(std::unique_ptr<v8::Task> task, double delay_in_seconds, const v8::SourceLocation& /*location*/) final;
+		void PostIdleTaskImpl(std::unique_ptr<v8::IdleTask> task, const v8::SourceLocation& /*location*/) final;
+		auto IdleTasksEnabled() -> bool final;
 		void PostNonNestableTaskImpl(std::unique_ptr<v8::Task> task, const v8::SourceLocation& location) final {
 #if V8_AT_LEAST(13, 3, 241)
 			PostTask(std::move(task), location);
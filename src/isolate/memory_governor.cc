@@ -0,0 +1,113 @@
+#include "memory_governor.h"
+#include "environment.h"
+#include "node_wrapper.h"
+#include <fstream>
+
+using namespace v8;
+
+namespace ivm {
+template <class Functor>
+void MemoryGovernor::ForEachOwnedIsolate(IsolateEnvironment& default_env, Functor callback) {
+	auto isolates = *default_env.owned_isolates->read(); // copy
+	for (const auto& handle : isolates) {
+		auto ref = handle.holder.lock();
+		if (ref) {
+			callback(*ref);
+		}
+	}
+}
+
+MemoryGovernor::MemoryGovernor(IsolateEnvironment& default_env, size_t moderate, size_t critical, uint32_t interval) :
+		default_env{default_env},
+		timer{new uv_timer_t},
+		moderate{moderate},
+		critical{critical} {
+#if defined __linux__
+	// cgroup v2 entries look like "0::/path/to/group"
+	std::ifstream cgroup{"/proc/self/cgroup"};
+	std::string line;
+	while (std::getline(cgroup, line)) {
+		if (line.rfind("0::", 0) == 0) {
+			auto path = "/sys/fs/cgroup" + line.substr(3) + "/memory.current";
+			if (std::ifstream{path}.good()) {
+				cgroup_path = std::move(path);
+			}
+			break;
+		}
+	}
+#endif
+	uv_timer_init(node::GetCurrentEventLoop(default_env.GetIsolate()), timer);
+	uv_unref(reinterpret_cast<uv_handle_t*>(timer));
+	timer->data = this;
+	uv_timer_start(timer, [](uv_timer_t* timer) {
+		static_cast<MemoryGovernor*>(timer->data)->Poll();
+	}, interval, interval);
+}
+
+MemoryGovernor::~MemoryGovernor() {
+	uv_close(reinterpret_cast<uv_handle_t*>(timer), [](uv_handle_t* handle) {
+		delete reinterpret_cast<uv_timer_t*>(handle);
+	});
+}
+
+auto MemoryGovernor::ReadProcessMemory() const -> size_t {
+	if (!cgroup_path.empty()) {
+		std::ifstream file{cgroup_path};
+		size_t value = 0;
+		if (file >> value) {
+			return value;
+		}
+	}
+	size_t rss = 0;
+	uv_resident_set_memory(&rss);
+	return rss;
+}
+
+void MemoryGovernor::Poll() {
+	auto usage = ReadProcessMemory();
+	auto level = [&]() {
+		if (critical != 0 && usage > critical) {
+			return MemoryPressureLevel::kCritical;
+		} else if (moderate != 0 && usage > moderate) {
+			return MemoryPressureLevel::kModerate;
+		} else {
+			return MemoryPressureLevel::kNone;
+		}
+	}();
+	// Only notify when a threshold is crossed, otherwise isolates would be collecting garbage
+	// constantly while the process is under pressure.
+	if (level > last_level) {
+		BroadcastMemoryPressure(default_env, level);
+	}
+	last_level = level;
+}
+
+void MemoryGovernor::BroadcastMemoryPressure(IsolateEnvironment& default_env, MemoryPressureLevel level) {
+	class MemoryPressureTask : public Runnable {
+		public:
+			explicit MemoryPressureTask(MemoryPressureLevel level) : level{level} {}
+			void Run() final {
+				IsolateEnvironment::GetCurrent().ApplyMemoryPressure(level);
+			}
+
+		private:
+			MemoryPressureLevel level;
+	};
+	ForEachOwnedIsolate(default_env, [&](IsolateHolder& holder) {
+		holder.ScheduleTask(std::make_unique<MemoryPressureTask>(level), false, true, true);
+	});
+}
+
+void MemoryGovernor::TrimMemory(IsolateEnvironment& default_env) {
+	class TrimMemoryTask : public Runnable {
+		public:
+			void Run() final {
+				IsolateEnvironment::GetCurrent().TrimMemory();
+			}
+	};
+	ForEachOwnedIsolate(default_env, [&](IsolateHolder& holder) {
+		holder.ScheduleTask(std::make_unique<TrimMemoryTask>(), false, true, true);
+	});
+}
+
+} // namespace ivm
@@ -0,0 +1,52 @@
+#pragma once
+#include <v8.h>
+#include <uv.h>
+#include <cstdint>
+#include <string>
+
+namespace ivm {
+
+class IsolateEnvironment;
+
+/**
+ * Watches memory usage of the whole process and relays memory pressure to every isolate owned by
+ * the default isolate. This lives on the default thread, and only the default isolate has one.
+ */
+class MemoryGovernor {
+	public:
+		MemoryGovernor(IsolateEnvironment& default_env, size_t moderate, size_t critical, uint32_t interval);
+		MemoryGovernor(const MemoryGovernor&) = delete;
+		~MemoryGovernor();
+		auto operator=(const MemoryGovernor&) = delete;
+
+		/**
+		 * Returns the memory in use by this process. On Linux this is the cgroup's `memory.current`,
+		 * otherwise it's the process RSS.
+		 */
+		auto ReadProcessMemory() const -> size_t;
+
+		/**
+		 * Sends a memory pressure notification to all isolates owned by `default_env`.
+		 */
+		static void BroadcastMemoryPressure(IsolateEnvironment& default_env, v8::MemoryPressureLevel level);
+
+		/**
+		 * Runs low-memory garbage collection and releases cached resources in all isolates owned by
+		 * `default_env`.
+		 */
+		static void TrimMemory(IsolateEnvironment& default_env);
+
+	private:
+		template <class Functor>
+		static void ForEachOwnedIsolate(IsolateEnvironment& default_env, Functor callback);
+		void Poll();
+
+		IsolateEnvironment& default_env;
+		uv_timer_t* timer;
+		std::string cgroup_path;
+		size_t moderate;
+		size_t critical;
+		v8::MemoryPressureLevel last_level = v8::MemoryPressureLevel::kNone;
+};
+
+} // namespace ivm
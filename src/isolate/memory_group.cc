@@ -0,0 +1,38 @@
+#include "memory_group.h"
+#include "generic/error.h"
+#include <algorithm>
+
+namespace ivm {
+
+MemoryGroup::Member::Member(std::shared_ptr<MemoryGroup> group, size_t floor) :
+		group{std::move(group)}, floor{floor}, charge{floor} {
+	auto reserved = this->group->reserved.load();
+	do {
+		if (reserved + floor > this->group->limit) {
+			throw RuntimeRangeError("`memoryFloor` exceeds the remaining budget of this IsolateGroup");
+		}
+	} while (!this->group->reserved.compare_exchange_weak(reserved, reserved + floor));
+	this->group->usage += floor;
+}
+
+MemoryGroup::Member::~Member() {
+	group->usage -= charge;
+	group->reserved -= floor;
+}
+
+auto MemoryGroup::Member::Charge(size_t usage) -> bool {
+	auto next_charge = std::max(usage, floor);
+	if (next_charge > charge) {
+		group->usage += next_charge - charge;
+	} else {
+		group->usage -= charge - next_charge;
+	}
+	charge = next_charge;
+	return usage <= floor || group->usage <= group->limit;
+}
+
+auto MemoryGroup::Member::Fits(size_t usage) const -> bool {
+	return usage <= floor || group->usage - charge + usage <= group->limit;
+}
+
+} // namespace ivm
@@ -0,0 +1,49 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace ivm {
+
+/**
+ * A memory budget shared by a group of isolates. Each member reserves a floor which is always
+ * available to it, and then draws on the remainder of the budget as its heap grows. A member is
+ * charged for the larger of its floor and its actual usage.
+ */
+class MemoryGroup {
+	public:
+		class Member {
+			public:
+				Member(std::shared_ptr<MemoryGroup> group, size_t floor);
+				Member(const Member&) = delete;
+				auto operator=(const Member&) = delete;
+				~Member();
+
+				/**
+				 * Records current usage of this member. Returns false if the group is now over budget and
+				 * this member is using more than its floor.
+				 */
+				auto Charge(size_t usage) -> bool;
+
+				/**
+				 * Same as `Charge` but doesn't record anything.
+				 */
+				auto Fits(size_t usage) const -> bool;
+
+			private:
+				std::shared_ptr<MemoryGroup> group;
+				size_t floor;
+				size_t charge;
+		};
+
+		explicit MemoryGroup(size_t limit) : limit{limit} {}
+		auto GetLimit() const -> size_t { return limit; }
+		auto GetUsage() const -> size_t { return usage; }
+
+	private:
+		const size_t limit;
+		std::atomic<size_t> reserved{0};
+		std::atomic<size_t> usage{0};
+};
+
+} // namespace ivm
@@ -14,7 +14,7 @@ class TaskRunner : public v8::TaskRunner {
 		// Methods for v8::TaskRunner
 		void PostTaskImpl(std::unique_ptr<v8::Task> task, const v8::SourceLocation& location) override = 0;
 		void PostDelayedTaskImpl(std::unique_ptr<v8::Task> task, double delay_in_seconds, const v8::SourceLocation& location) override = 0;
-		void PostIdleTaskImpl(std::unique_ptr<v8::IdleTask> /*task*/, const v8::SourceLocation& /*location*/) final { std::terminate(); }
+		void PostIdleTaskImpl(std::unique_ptr<v8::IdleTask> /*task*/, const v8::SourceLocation& /*location*/) override { std::terminate(); }
 		// Can't be final because symbol is also used in IsolatePlatformDelegate
 		auto IdleTasksEnabled() -> bool override { return false; };
 		auto NonNestableTasksEnabled() const -> bool final { return true; }
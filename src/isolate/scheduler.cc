@@ -62,7 +62,13 @@ auto LockedScheduler::GetForegroundTaskRunner() -> std::shared_ptr<v8::TaskRunne
 void LockedScheduler::DecrementUvRefForIsolate(const std::shared_ptr<IsolateHolder>& holder) {
 	auto ref = holder->GetIsolate();
 	if (ref) {
-		ref->scheduler->DecrementUvRef();
+		auto& scheduler = *ref->scheduler;
+		if (ref->IsDefault()) {
+			// Once the count reaches zero the default thread may begin tearing itself down, so this
+			// thread must not be left holding the last reference.
+			ref.reset();
+		}
+		scheduler.DecrementUvRef();
 	}
 }
 
@@ -73,9 +79,14 @@ void LockedScheduler::IncrementUvRefForIsolate(const std::shared_ptr<IsolateHold
 	}
 }
 
+auto LockedScheduler::IdleTasksEnabled() -> bool {
+	return env.GetIdleCollectionDelay() != 0;
+}
+
 IsolatedScheduler::IsolatedScheduler(IsolateEnvironment& env, UvScheduler& default_scheduler) :
 	LockedScheduler{env},
-	default_scheduler{default_scheduler} {}
+	default_scheduler{default_scheduler},
+	idle_wakes{default_scheduler.idle_wakes} {}
 
 void IsolatedScheduler::DecrementUvRef() {
 	default_scheduler.DecrementUvRef();
@@ -85,6 +96,16 @@ void IsolatedScheduler::IncrementUvRef() {
 	default_scheduler.IncrementUvRef();
 }
 
+void IsolatedScheduler::RequestIdleWake(unsigned epoch) {
+	// The default scheduler may already be gone, so only the shared state is used here. Holding the
+	// lock keeps the handle open until the send is done.
+	auto lock = idle_wakes->write();
+	if (lock->uv_async != nullptr) {
+		lock->wakes.push_back({ env.weak_from_this(), epoch });
+		uv_async_send(lock->uv_async);
+	}
+}
+
 void IsolatedScheduler::SendWake() {
 	thread_pool.exec(thread_affinity, [](bool pool_thread, void* param) {
 		auto& scheduler = *static_cast<IsolatedScheduler*>(param);
@@ -110,9 +131,19 @@ void IsolatedScheduler::SendWake() {
 UvScheduler::UvScheduler(IsolateEnvironment& env) :
 		LockedScheduler{env},
 		loop{node::GetCurrentEventLoop(v8::Isolate::GetCurrent())},
-		uv_async{new uv_async_t} {
+		uv_async{new uv_async_t},
+		idle_wakes{std::make_shared<lockable_t<IdleWakes>>()} {
 	uv_async_init(loop, uv_async, [](uv_async_t* async) {
 		auto& scheduler = *static_cast<UvScheduler*>(async->data);
+		// Idle wakes are sent from timer threads, but waking an isolate must happen here since it may
+		// need to ref the uv handle.
+		auto idle_wakes = ExchangeDefault(scheduler.idle_wakes->write()->wakes);
+		for (auto& wake : idle_wakes) {
+			auto env = wake.env.lock();
+			if (env) {
+				env->WakeForIdleCollection(wake.epoch);
+			}
+		}
 		auto ref = [&]() {
 			// Lock is required to access env_ref on the default scheduler but a non-default scheduler
 			// doesn't need it. This is because `WakeIsolate` can trigger this function via
@@ -133,9 +164,11 @@ UvScheduler::UvScheduler(IsolateEnvironment& env) :
 	});
 	uv_async->data = this;
 	uv_unref(reinterpret_cast<uv_handle_t*>(uv_async));
+	idle_wakes->write()->uv_async = uv_async;
 }
 
 UvScheduler::~UvScheduler() {
+	idle_wakes->write()->uv_async = nullptr;
 	uv_close(reinterpret_cast<uv_handle_t*>(uv_async), [](uv_handle_t* handle) {
 		delete reinterpret_cast<uv_async_t*>(handle);
 	});
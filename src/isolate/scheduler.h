@@ -9,6 +9,7 @@
 #include <memory>
 #include <mutex>
 #include <queue>
+#include <vector>
 
 namespace ivm {
 class IsolateEnvironment;
@@ -26,6 +27,18 @@ auto ExchangeDefault(Type& container) {
  * This does all the interaction with libuv async and the thread pool.
  */
 class UvScheduler;
+
+// Idle collection wakes which timer threads hand off to the default thread. `uv_async` is cleared
+// when the default scheduler goes away so no more wakes are sent to it.
+struct IdleWakes {
+	struct IdleWake {
+		std::weak_ptr<IsolateEnvironment> env;
+		unsigned epoch;
+	};
+	std::vector<IdleWake> wakes;
+	uv_async_t* uv_async = nullptr;
+};
+
 class Scheduler {
 	friend IsolateEnvironment;
 	friend class LockedScheduler;
@@ -80,6 +93,11 @@ class Scheduler {
 		TaskQueue handle_tasks;
 		TaskQueue interrupts;
 		TaskQueue sync_interrupts;
+		std::queue<std::unique_ptr<v8::IdleTask>> idle_tasks;
+		// Set when the isolate should run an idle collection the next time it wakes up
+		bool idle_collection = false;
+		// Number of parked tasks waiting on work v8 posts to this isolate, see `IsolateTaskRunner`
+		unsigned wake_on_posted_tasks = 0;
 
 	protected:
 		mutable std::mutex mutex;
@@ -123,7 +141,7 @@ class LockedScheduler : protected Scheduler, public node::IsolatePlatformDelegat
 
 		// IsolatePlatformDelegate overrides
 		auto GetForegroundTaskRunner() -> std::shared_ptr<v8::TaskRunner> final;
-		auto IdleTasksEnabled() -> bool final { return false; }
+		auto IdleTasksEnabled() -> bool final;
 
 		// Used to ref/unref the uv handle from C++ API
 		static void DecrementUvRefForIsolate(const std::shared_ptr<IsolateHolder>& holder);
@@ -134,6 +152,10 @@ class IsolatedScheduler final : public LockedScheduler {
 	public:
 		explicit IsolatedScheduler(IsolateEnvironment& env, UvScheduler& default_scheduler);
 
+		// Asks the default thread to wake this isolate for an idle collection. This may be invoked from
+		// any thread, since the wake itself happens on the default thread.
+		void RequestIdleWake(unsigned epoch);
+
 	private:
 		void DecrementUvRef() override;
 		void IncrementUvRef() override;
@@ -141,6 +163,7 @@ class IsolatedScheduler final : public LockedScheduler {
 
 		thread_pool_t::affinity_t thread_affinity;
 		UvScheduler& default_scheduler;
+		std::shared_ptr<lockable_t<IdleWakes>> idle_wakes;
 };
 
 class UvScheduler final : public LockedScheduler {
@@ -160,6 +183,8 @@ class UvScheduler final : public LockedScheduler {
 		uv_loop_t* loop = nullptr;
 		uv_async_t* uv_async = nullptr;
 		std::atomic<int> uv_ref_count{0};
+		// Shared with every isolated scheduler so timer threads never touch this instance directly
+		std::shared_ptr<lockable_t<IdleWakes>> idle_wakes;
 };
 
 } // namespace ivm
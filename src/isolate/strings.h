@@ -44,53 +44,92 @@ class StringTable {
 		static auto Get() -> auto&;
 
 		// StringTable::Get().
+		String WebAssembly{"WebAssembly"};
 		String accessors{"accessors"};
 		String arguments{"arguments"};
 		String async{"async"};
 		String boolean{"boolean"};
+		String cache{"cache"};
+		String cacheDirectory{"cacheDirectory"};
 		String cachedData{"cachedData"};
 		String cachedDataRejected{"cachedDataRejected"};
 		String code{"code"};
+		String compile{"compile"};
+		String compileStreaming{"compileStreaming"};
 		// String codeGenerationError{"Code generation from large string was denied"};
 		String colonSpace{": "};
 		String columnOffset{"columnOffset"};
+		String contextPoolSize{"contextPoolSize"};
+		String contexts{"contexts"};
 		String copy{"copy"};
+		String cpuTime{"cpuTime"};
+		String critical{"critical"};
+		String eager{"eager"};
+		String entries{"entries"};
+		String evalCacheHits{"evalCacheHits"};
+		String evalCacheMisses{"evalCacheMisses"};
+		String evalCacheSize{"evalCacheSize"};
 		String externalCopy{"externalCopy"};
 		String filename{"filename"};
 		String function{"function"};
 		String global{"global"};
+		String group{"group"};
+		String hits{"hits"};
+		String idleCollectionDelay{"idleCollectionDelay"};
 		String ignored{"ignored"};
+		String initialOldGenerationSize{"initialOldGenerationSize"};
+		String initialYoungGenerationSize{"initialYoungGenerationSize"};
 		String inspector{"inspector"};
+		String interval{"interval"};
+		String isolate{"isolate"};
 		String isolateIsDisposed{"Isolate is disposed"};
 		String isolatedVm{"isolated-vm"};
+		String lazyDefaultContext{"lazyDefaultContext"};
 		String length{"length"};
 		String lineOffset{"lineOffset"};
+		String maxEntries{"maxEntries"};
+		String maxSize{"maxSize"};
 		String message{"message"};
+		String memoryFloor{"memoryFloor"};
+		String memoryLimit{"memoryLimit"};
 		String meta{"meta"};
+		String misses{"misses"};
+		String moderate{"moderate"};
 		String name{"name"};
 		String null{"null"};
 		String number{"number"};
 		String object{"object"};
 		String onCatastrophicError{"onCatastrophicError"};
+		String onSoftMemoryLimit{"onSoftMemoryLimit"};
 		String produceCachedData{"produceCachedData"};
 		String promise{"promise"};
+		String queueDepth{"queueDepth"};
 		String reference{"reference"};
 		String release{"release"};
 		String result{"result"};
+		String size{"size"};
 		String snapshot{"snapshot"};
+		String snapshotIndex{"snapshotIndex"};
+		String softMemoryLimit{"softMemoryLimit"};
+		String specifier{"specifier"};
 		String stack{"stack"};
 		String string{"string"};
 		String timeout{"timeout"};
+		String timestamp{"timestamp"};
 		String transferIn{"transferIn"};
 		String transferList{"transferList"};
 		String transferOut{"transferOut"};
 		String undefined{"undefined"};
 		String unsafeInherit{"unsafeInherit"};
+		String wallTime{"wallTime"};
+		String workload{"workload"};
 
 		String does_zap_garbage{"does_zap_garbage"};
 		String externally_allocated_size{"externally_allocated_size"};
 		String heap_size_limit{"heap_size_limit"};
 		String malloced_memory{"malloced_memory"};
+		String number_of_detached_contexts{"number_of_detached_contexts"};
+		String number_of_native_contexts{"number_of_native_contexts"};
 		String peak_malloced_memory{"peak_malloced_memory"};
 		String total_available_size{"total_available_size"};
 		String total_heap_size{"total_heap_size"};
@@ -1,11 +1,19 @@
 #include "three_phase_task.h"
 #include "external_copy/external_copy.h"
+#include "lib/thread_pool.h"
 #include <cstring>
+#include <thread>
 
 using namespace v8;
 using std::unique_ptr;
 
 namespace ivm {
+namespace {
+
+thread_pool_t background_threads{std::thread::hardware_concurrency()};
+thread_pool_t::affinity_t background_affinity;
+
+} // anonymous namespace
 
 /**
  * CalleeInfo implementation
@@ -55,13 +63,18 @@ struct CallbackScope {
  */
 ThreePhaseTask::Phase2Runner::Phase2Runner(
 	unique_ptr<ThreePhaseTask> self,
-	CalleeInfo info
+	CalleeInfo info,
+	bool finalize
 ) :
 	self(std::move(self)),
-	info(std::move(info))	{}
+	info(std::move(info)),
+	finalize{finalize} {}
 
 ThreePhaseTask::Phase2Runner::~Phase2Runner() {
 	if (!did_run) {
+		if (finalize) {
+			self->Phase2Abandon();
+		}
 		// The task never got to run
 		struct Phase3Orphan : public Runnable {
 			unique_ptr<ThreePhaseTask> self;
@@ -172,16 +185,41 @@ void ThreePhaseTask::Phase2Runner::Run() {
 
 	did_run = true;
 	auto schedule_error = [&](std::unique_ptr<ExternalCopy> error) {
+		if (std::exchange(self->deferred, false) || finalize) {
+			self->Phase2Abandon();
+		}
 		// Schedule a task to enter the first isolate so we can throw the error at the promise
 		auto* holder = info.remotes.GetIsolateHolder();
 		holder->ScheduleTask(std::make_unique<Phase3Failure>(std::move(self), std::move(info), std::move(error)), false, true);
 	};
-	FunctorRunners::RunCatchExternal(IsolateEnvironment::GetCurrent().DefaultContext(), [&]() {
+	FunctorRunners::RunCatchExternal([]() { return IsolateEnvironment::GetCurrent().DefaultContext(); }, [&]() {
 		// Continue the task
-		self->Phase2();
-		auto epilogue_error = IsolateEnvironment::GetCurrent().TaskEpilogue();
+		auto& env = IsolateEnvironment::GetCurrent();
+		if (finalize) {
+			env.AdjustRemotes(-1);
+			self->Phase2Finalize();
+		} else {
+			self->may_defer = true;
+			self->Phase2();
+		}
+		auto epilogue_error = env.TaskEpilogue();
 		if (epilogue_error) {
 			schedule_error(std::move(epilogue_error));
+		} else if (std::exchange(self->deferred, false)) {
+			// Counting the background work as a reference keeps the isolate from hibernating under it
+			env.AdjustRemotes(1);
+			RunBackground(std::make_unique<Phase2Runner>(std::move(self), std::move(info), true));
+		} else if (std::exchange(self->parked, false)) {
+			// Same as above, the task stays with the isolate and `Resume()` schedules it again. It may
+			// have been resumed already.
+			env.AdjustRemotes(1);
+			auto* task = self.get();
+			auto runner = std::make_unique<Phase2Runner>(std::move(self), std::move(info), true);
+			if (std::exchange(task->resumed, false)) {
+				env.ScheduleOwnTask(std::move(runner));
+			} else {
+				env.parked_tasks.emplace(task, std::make_unique<Phase2Parked>(std::move(runner), env));
+			}
 		} else {
 			auto* holder = info.remotes.GetIsolateHolder();
 			holder->ScheduleTask(std::make_unique<Phase3Success>(std::move(self), std::move(info)), false, true);
@@ -189,6 +227,73 @@ void ThreePhaseTask::Phase2Runner::Run() {
 	}, schedule_error);
 }
 
+void ThreePhaseTask::Phase2Runner::RunBackground(unique_ptr<Phase2Runner> runner) {
+	struct BackgroundTask {
+		unique_ptr<Phase2Runner> runner;
+		std::shared_ptr<IsolateEnvironment> env;
+		std::shared_ptr<IsolateHolder> default_holder;
+	};
+
+	// The environment reference keeps the isolate around for `Phase2Abandon()` if it's disposed while
+	// this is running. The uv ref is taken on the default isolate so that it can be released either
+	// way.
+	auto& env = IsolateEnvironment::GetCurrent();
+	auto default_holder = Executor::GetDefaultEnvironment().GetHolder().lock();
+	LockedScheduler::IncrementUvRefForIsolate(default_holder);
+	auto* task = new BackgroundTask{std::move(runner), env.shared_from_this(), std::move(default_holder)};
+	background_threads.exec(background_affinity, [](bool /*pool_thread*/, void* param) {
+		unique_ptr<BackgroundTask> task{static_cast<BackgroundTask*>(param)};
+		task->runner->self->Phase2Background();
+		{
+			// If the isolate was disposed this drops the runner, which rejects the promise
+			Executor::Scope scope{*task->env};
+			auto holder = task->env->GetHolder().lock();
+			if (holder) {
+				holder->ScheduleTask(std::move(task->runner), false, true);
+			} else {
+				task->runner.reset();
+			}
+		}
+		task->env.reset();
+		LockedScheduler::DecrementUvRefForIsolate(task->default_holder);
+	}, task);
+}
+
+/**
+ * Phase2Parked implementation
+ */
+ThreePhaseTask::Phase2Parked::Phase2Parked(unique_ptr<Phase2Runner> runner, IsolateEnvironment& env) :
+		runner{std::move(runner)},
+		env{env},
+		default_holder{Executor::GetDefaultEnvironment().GetHolder().lock()} {
+	// This runs in the isolate, which already holds a uv ref on the default isolate, so the count
+	// can't start from zero here
+	LockedScheduler::IncrementUvRefForIsolate(default_holder);
+	++env.GetScheduler().Lock()->wake_on_posted_tasks;
+}
+
+ThreePhaseTask::Phase2Parked::~Phase2Parked() {
+	--env.GetScheduler().Lock()->wake_on_posted_tasks;
+	LockedScheduler::DecrementUvRefForIsolate(default_holder);
+}
+
+void ThreePhaseTask::Phase2Parked::Run() {
+	env.ScheduleOwnTask(std::move(runner));
+}
+
+void ThreePhaseTask::Resume(ThreePhaseTask& task) {
+	auto& env = IsolateEnvironment::GetCurrent();
+	auto it = env.parked_tasks.find(&task);
+	if (it == env.parked_tasks.end()) {
+		// `Phase2()` or `Phase2Finalize()` hasn't returned yet
+		task.resumed = true;
+	} else {
+		auto parked = std::move(it->second);
+		env.parked_tasks.erase(it);
+		parked->Run();
+	}
+}
+
 /**
  * Phase2RunnerIgnored implementation
  */
@@ -251,7 +356,7 @@ auto ThreePhaseTask::RunSync(IsolateHolder& second_isolate, bool allow_async) ->
 				run_handle_tasks(*second_isolate_ref);
 
 				// Now run the actual work
-				FunctorRunners::RunCatchExternal(second_isolate_ref->DefaultContext(), [&]() {
+				FunctorRunners::RunCatchExternal([&]() { return second_isolate_ref->DefaultContext(); }, [&]() {
 					// Run Phase2 and externalize errors
 					Phase2();
 					if (!is_recursive) {
@@ -316,7 +421,7 @@ auto ThreePhaseTask::RunSync(IsolateHolder& second_isolate, bool allow_async) ->
 
 				void Run() final {
 					did_run = true;
-					FunctorRunners::RunCatchExternal(IsolateEnvironment::GetCurrent().DefaultContext(), [ this ]() {
+					FunctorRunners::RunCatchExternal([]() { return IsolateEnvironment::GetCurrent().DefaultContext(); }, [ this ]() {
 						// Now in the default thread
 						const auto is_async = [&]() {
 							if (allow_async) {
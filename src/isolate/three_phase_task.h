@@ -57,14 +57,35 @@ class ThreePhaseTask {
 			CalleeInfo info;
 			bool did_run = false;
 
+			bool finalize = false;
+
 			Phase2Runner(
 				std::unique_ptr<ThreePhaseTask> self,
-				CalleeInfo info
+				CalleeInfo info,
+				bool finalize = false
 			);
 			Phase2Runner(const Phase2Runner&) = delete;
 			auto operator= (const Phase2Runner&) -> Phase2Runner& = delete;
 			~Phase2Runner() final;
 			void Run() final;
+			static void RunBackground(std::unique_ptr<Phase2Runner> runner);
+		};
+
+		/**
+		 * Holds a runner parked by `DeferUntilResumed()` in the isolate, and `Run()` resumes it. While
+		 * one exists the tasks v8 posts to the isolate wake it up. The uv ref taken on the default
+		 * isolate here is what makes that safe from v8's threads.
+		 */
+		struct Phase2Parked final : public Runnable {
+			std::unique_ptr<Phase2Runner> runner;
+			IsolateEnvironment& env;
+			std::shared_ptr<IsolateHolder> default_holder;
+
+			Phase2Parked(std::unique_ptr<Phase2Runner> runner, IsolateEnvironment& env);
+			Phase2Parked(const Phase2Parked&) = delete;
+			auto operator= (const Phase2Parked&) -> Phase2Parked& = delete;
+			~Phase2Parked() final;
+			void Run() final;
 		};
 
 		/**
@@ -78,6 +99,34 @@ class ThreePhaseTask {
 
 		auto RunSync(IsolateHolder& second_isolate, bool allow_async) -> v8::Local<v8::Value>;
 
+		bool may_defer = false;
+		bool deferred = false;
+		bool parked = false;
+		bool resumed = false;
+
+	protected:
+		/**
+		 * Called from `Phase2()` to hand the rest of the work off to `Phase2Background()`. Returns false
+		 * if the task is running synchronously, in which case `Phase2()` should finish up by itself.
+		 * `Phase2Finalize()` may call this again to go around another time.
+		 */
+		auto DeferToBackground() -> bool {
+			deferred = may_defer;
+			return deferred;
+		}
+
+		/**
+		 * Like `DeferToBackground()` but instead of running `Phase2Background()` the task waits in the
+		 * isolate until `Resume()` is called, and then `Phase2Finalize()` runs. This is for work which
+		 * finishes on its own inside the isolate, for example a promise v8 settles. If the isolate is
+		 * disposed first then `Phase2Abandon()` runs.
+		 */
+		auto DeferUntilResumed() -> bool {
+			parked = may_defer;
+			return parked;
+		}
+		static void Resume(ThreePhaseTask& task);
+
 	public:
 		ThreePhaseTask() = default;
 		ThreePhaseTask(const ThreePhaseTask&) = delete;
@@ -90,6 +139,15 @@ class ThreePhaseTask {
 			return false;
 		}
 
+		/**
+		 * When `Phase2()` defers, `Phase2Background()` runs on a thread pool without the isolate locked
+		 * and then `Phase2Finalize()` runs back in the isolate. If the isolate is disposed in the
+		 * meantime `Phase2Abandon()` runs instead, while the isolate still exists but isn't locked.
+		 */
+		virtual void Phase2Background() {}
+		virtual void Phase2Finalize() {}
+		virtual void Phase2Abandon() {}
+
 		virtual auto Phase3() -> v8::Local<v8::Value> = 0;
 
 		template <int async, typename T, typename ...Args>
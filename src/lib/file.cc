@@ -0,0 +1,54 @@
+#include "file.h"
+#include <cstdio>
+#ifdef _WIN32
+#include <atomic>
+#include <fstream>
+#include <process.h>
+#else
+#include <cerrno>
+#include <cstdlib>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ivm {
+
+auto write_file_atomic(const std::string& path, const void* data, size_t length) -> bool {
+#ifdef _WIN32
+	// There's no mkstemp, but the pid and a counter are unique among the processes sharing a directory
+	static std::atomic<unsigned> counter{0};
+	auto temp_path = path + "." + std::to_string(_getpid()) + "." + std::to_string(counter++) + ".tmp";
+	bool ok = [&]() {
+		std::ofstream file{temp_path, std::ios::binary | std::ios::trunc};
+		return static_cast<bool>(file.write(static_cast<const char*>(data), length));
+	}();
+#else
+	std::string temp_path = path + ".XXXXXX";
+	int fd = mkstemp(temp_path.data());
+	if (fd == -1) {
+		return false;
+	}
+	const auto* bytes = static_cast<const char*>(data);
+	size_t written = 0;
+	while (written < length) {
+		auto result = write(fd, bytes + written, length - written);
+		if (result == -1) {
+			if (errno == EINTR) {
+				continue;
+			}
+			break;
+		}
+		written += static_cast<size_t>(result);
+	}
+	// mkstemp creates files which only the owner can read, but other users may share the directory
+	bool ok = written == length && fchmod(fd, 0644) == 0;
+	ok = close(fd) == 0 && ok;
+#endif
+	if (!ok || std::rename(temp_path.c_str(), path.c_str()) != 0) {
+		std::remove(temp_path.c_str());
+		return false;
+	}
+	return true;
+}
+
+} // namespace ivm
@@ -0,0 +1,13 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+namespace ivm {
+
+// Replaces the file at `path` with `length` bytes of `data`. The bytes are written to a uniquely
+// named temporary file in the same directory which is then renamed over `path`, so readers and
+// writers in other threads or processes never see a partial file. Returns false on any failure, in
+// which case the temporary file is removed.
+auto write_file_atomic(const std::string& path, const void* data, size_t length) -> bool;
+
+} // namespace ivm
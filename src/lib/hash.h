@@ -0,0 +1,148 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace ivm {
+
+// Incremental 64-bit FNV-1a. This is used to name cache entries, not for anything adversarial. Each
+// update also mixes in the length of the piece so that ("ab", "c") and ("a", "bc") don't collide.
+class fnv1a_t {
+	public:
+		auto update(const void* data, size_t length) -> fnv1a_t& {
+			mix(&length, sizeof(length));
+			mix(data, length);
+			return *this;
+		}
+
+		auto update(const std::string& string) -> fnv1a_t& {
+			return update(string.data(), string.size());
+		}
+
+		auto digest() const -> uint64_t { return value; }
+
+		auto hex() const -> std::string {
+			char buffer[17];
+			std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(value));
+			return buffer;
+		}
+
+	private:
+		void mix(const void* data, size_t length) {
+			const auto* bytes = static_cast<const unsigned char*>(data);
+			for (size_t ii = 0; ii < length; ++ii) {
+				value = (value ^ bytes[ii]) * 0x100000001b3ULL;
+			}
+		}
+
+		uint64_t value = 0xcbf29ce484222325ULL;
+};
+
+// Incremental SHA-256, for checking that data which may have come from somewhere else really
+// belongs to a key.
+class sha256_t {
+	public:
+		using digest_t = std::array<unsigned char, 32>;
+
+		auto update(const void* data, size_t length) -> sha256_t& {
+			const auto* bytes = static_cast<const unsigned char*>(data);
+			total += length;
+			while (length > 0) {
+				size_t count = std::min(length, sizeof(block) - used);
+				std::memcpy(block + used, bytes, count);
+				used += count;
+				bytes += count;
+				length -= count;
+				if (used == sizeof(block)) {
+					compress();
+					used = 0;
+				}
+			}
+			return *this;
+		}
+
+		auto update(const std::string& string) -> sha256_t& {
+			return update(string.data(), string.size());
+		}
+
+		auto digest() const -> digest_t {
+			auto copy = *this;
+			uint64_t bits = copy.total * 8;
+			unsigned char padding = 0x80;
+			copy.update(&padding, 1);
+			padding = 0;
+			while (copy.used != sizeof(block) - 8) {
+				copy.update(&padding, 1);
+			}
+			unsigned char length[8];
+			for (int ii = 0; ii < 8; ++ii) {
+				length[ii] = static_cast<unsigned char>(bits >> (56 - ii * 8));
+			}
+			copy.update(length, sizeof(length));
+			digest_t result;
+			for (size_t ii = 0; ii < 8; ++ii) {
+				for (size_t jj = 0; jj < 4; ++jj) {
+					result[ii * 4 + jj] = static_cast<unsigned char>(copy.state[ii] >> (24 - jj * 8));
+				}
+			}
+			return result;
+		}
+
+	private:
+		static auto rotate(uint32_t value, int bits) -> uint32_t {
+			return (value >> bits) | (value << (32 - bits));
+		}
+
+		void compress() {
+			static constexpr uint32_t k[64] = {
+				0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+				0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+				0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+				0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+				0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+				0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+				0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+				0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+			};
+			uint32_t w[64];
+			for (size_t ii = 0; ii < 16; ++ii) {
+				w[ii] =
+					(uint32_t{block[ii * 4]} << 24) | (uint32_t{block[ii * 4 + 1]} << 16) |
+					(uint32_t{block[ii * 4 + 2]} << 8) | uint32_t{block[ii * 4 + 3]};
+			}
+			for (size_t ii = 16; ii < 64; ++ii) {
+				uint32_t s0 = rotate(w[ii - 15], 7) ^ rotate(w[ii - 15], 18) ^ (w[ii - 15] >> 3);
+				uint32_t s1 = rotate(w[ii - 2], 17) ^ rotate(w[ii - 2], 19) ^ (w[ii - 2] >> 10);
+				w[ii] = w[ii - 16] + s0 + w[ii - 7] + s1;
+			}
+			uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+			uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+			for (size_t ii = 0; ii < 64; ++ii) {
+				uint32_t t1 = h + (rotate(e, 6) ^ rotate(e, 11) ^ rotate(e, 25)) + ((e & f) ^ (~e & g)) + k[ii] + w[ii];
+				uint32_t t2 = (rotate(a, 2) ^ rotate(a, 13) ^ rotate(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+				h = g;
+				g = f;
+				f = e;
+				e = d + t1;
+				d = c;
+				c = b;
+				b = a;
+				a = t1 + t2;
+			}
+			state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+			state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+		}
+
+		uint32_t state[8] = {
+			0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+		};
+		unsigned char block[64] {};
+		size_t used = 0;
+		uint64_t total = 0;
+};
+
+} // namespace ivm
@@ -0,0 +1,64 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace ivm {
+
+// Sequence lock for small, trivially copyable values. The writer never waits on readers and readers
+// never take a lock; a read which overlaps a write is simply retried. Only one thread may write at a
+// time, which is guaranteed by the caller. The value is stored as relaxed atomic words so that
+// torn reads are well defined, and then discarded.
+template <class Type>
+class seqlock_t {
+	static_assert(std::is_trivially_copyable_v<Type>, "seqlock_t requires a trivially copyable type");
+	using word_t = uint64_t;
+	static constexpr size_t kWords = (sizeof(Type) + sizeof(word_t) - 1) / sizeof(word_t);
+	using buffer_t = std::array<word_t, kWords>;
+
+	public:
+		seqlock_t() : seqlock_t{Type{}} {}
+		explicit seqlock_t(const Type& value) {
+			write(value);
+		}
+
+		void write(const Type& value) {
+			buffer_t buffer{};
+			std::memcpy(buffer.data(), static_cast<const void*>(&value), sizeof(Type));
+			auto current = sequence.load(std::memory_order_relaxed);
+			sequence.store(current + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			for (size_t ii = 0; ii < kWords; ++ii) {
+				words[ii].store(buffer[ii], std::memory_order_relaxed);
+			}
+			sequence.store(current + 2, std::memory_order_release);
+		}
+
+		auto read() const -> Type {
+			buffer_t buffer;
+			while (true) {
+				auto before = sequence.load(std::memory_order_acquire);
+				if ((before & 1) != 0) {
+					continue;
+				}
+				for (size_t ii = 0; ii < kWords; ++ii) {
+					buffer[ii] = words[ii].load(std::memory_order_relaxed);
+				}
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (sequence.load(std::memory_order_relaxed) == before) {
+					break;
+				}
+			}
+			Type value;
+			std::memcpy(static_cast<void*>(&value), buffer.data(), sizeof(Type));
+			return value;
+		}
+
+	private:
+		std::atomic<uint64_t> sequence{0};
+		std::array<std::atomic<word_t>, kWords> words{};
+};
+
+} // namespace ivm
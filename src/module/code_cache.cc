@@ -0,0 +1,205 @@
+#include "code_cache.h"
+#include "lib/file.h"
+#include "lib/hash.h"
+#include "lib/lockable.h"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace ivm {
+namespace {
+
+struct Entry {
+	std::string key;
+	std::shared_ptr<v8::BackingStore> data;
+};
+
+struct State {
+	// Most recently used first
+	std::list<Entry> entries;
+	std::unordered_map<std::string, std::list<Entry>::iterator> index;
+	size_t size = 0;
+	size_t max_size = 0;
+
+	void Erase(std::list<Entry>::iterator it) {
+		size -= it->data->ByteLength();
+		index.erase(it->key);
+		entries.erase(it);
+	}
+
+	void Insert(const std::string& key, std::shared_ptr<v8::BackingStore> data) {
+		if (data->ByteLength() > max_size) {
+			return;
+		}
+		auto it = index.find(key);
+		if (it != index.end()) {
+			Erase(it->second);
+		}
+		size += data->ByteLength();
+		entries.push_front({ key, std::move(data) });
+		index.emplace(key, entries.begin());
+		Trim();
+	}
+
+	void Trim() {
+		while (size > max_size) {
+			Erase(std::prev(entries.end()));
+		}
+	}
+};
+
+lockable_t<State> state;
+lockable_t<std::string> directory;
+std::atomic<size_t> max_size{0};
+std::atomic<bool> has_directory{false};
+std::atomic<size_t> hits{0};
+std::atomic<size_t> misses{0};
+
+auto PathFor(const std::string& directory, const std::string& key) -> std::string {
+	return directory + "/" + fnv1a_t{}.update(key).hex() + ".code";
+}
+
+// Each file starts with a SHA-256 digest of the full key. File names are only a short hash, so this
+// is what makes sure the data belongs to the source which is being compiled.
+constexpr size_t kHeaderSize = std::tuple_size_v<sha256_t::digest_t>;
+
+// Cache files are mapped instead of read since v8 only looks at parts of the data
+auto Load(const std::string& path, const std::string& key) -> std::shared_ptr<v8::BackingStore> {
+	auto digest = sha256_t{}.update(key).digest();
+#ifdef _WIN32
+	std::ifstream file{path, std::ios::binary | std::ios::ate};
+	if (!file) {
+		return nullptr;
+	}
+	auto size = static_cast<size_t>(file.tellg());
+	if (size <= kHeaderSize) {
+		return nullptr;
+	}
+	sha256_t::digest_t header;
+	file.seekg(0);
+	if (!file.read(reinterpret_cast<char*>(header.data()), kHeaderSize) || header != digest) {
+		return nullptr;
+	}
+	size -= kHeaderSize;
+	auto* data = new char[size];
+	if (!file.read(data, size)) {
+		delete[] data;
+		return nullptr;
+	}
+	return v8::ArrayBuffer::NewBackingStore(
+		data, size,
+		[](void* data, size_t /*length*/, void* /*param*/) { delete[] static_cast<char*>(data); },
+		nullptr);
+#else
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd == -1) {
+		return nullptr;
+	}
+	struct stat info {};
+	void* data = MAP_FAILED;
+	if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) > kHeaderSize) {
+		data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+	close(fd);
+	if (data == MAP_FAILED) {
+		return nullptr;
+	}
+	if (std::memcmp(data, digest.data(), kHeaderSize) != 0) {
+		munmap(data, info.st_size);
+		return nullptr;
+	}
+	return v8::ArrayBuffer::NewBackingStore(
+		static_cast<char*>(data) + kHeaderSize, info.st_size - kHeaderSize,
+		[](void* data, size_t length, void* /*param*/) {
+			munmap(static_cast<char*>(data) - kHeaderSize, length + kHeaderSize);
+		},
+		nullptr);
+#endif
+}
+
+auto Save(const std::string& path, const std::string& key, const v8::BackingStore& data) -> bool {
+	auto digest = sha256_t{}.update(key).digest();
+	std::vector<char> contents(kHeaderSize + data.ByteLength());
+	std::memcpy(contents.data(), digest.data(), kHeaderSize);
+	std::memcpy(contents.data() + kHeaderSize, data.Data(), data.ByteLength());
+	return write_file_atomic(path, contents.data(), contents.size());
+}
+
+} // anonymous namespace
+
+auto CodeCache::IsEnabled() -> bool {
+	return max_size != 0 || has_directory;
+}
+
+auto CodeCache::Lookup(const std::string& key) -> std::shared_ptr<v8::BackingStore> {
+	if (max_size != 0) {
+		auto lock = state.write();
+		auto it = lock->index.find(key);
+		if (it != lock->index.end()) {
+			lock->entries.splice(lock->entries.begin(), lock->entries, it->second);
+			return it->second->data;
+		}
+	}
+	if (has_directory) {
+		auto data = Load(PathFor(*directory.read(), key), key);
+		if (data) {
+			if (max_size != 0) {
+				state.write()->Insert(key, data);
+			}
+			return data;
+		}
+	}
+	++misses;
+	return {};
+}
+
+void CodeCache::RecordConsumed(bool rejected) {
+	++(rejected ? misses : hits);
+}
+
+void CodeCache::Insert(const std::string& key, std::shared_ptr<v8::BackingStore> data) {
+	if (has_directory) {
+		// Failure just means the next process compiles it again
+		Save(PathFor(*directory.read(), key), key, *data);
+	}
+	if (max_size != 0) {
+		state.write()->Insert(key, std::move(data));
+	}
+}
+
+void CodeCache::SetMaxSize(size_t size) {
+	auto lock = state.write();
+	lock->max_size = size;
+	max_size = size;
+	lock->Trim();
+}
+
+auto CodeCache::SetDirectory(std::string path) -> bool {
+	if (!path.empty()) {
+		struct stat info {};
+		if (stat(path.c_str(), &info) != 0 || (info.st_mode & S_IFMT) != S_IFDIR) {
+			return false;
+		}
+	}
+	auto lock = directory.write();
+	has_directory = !path.empty();
+	*lock = std::move(path);
+	return true;
+}
+
+auto CodeCache::GetStatistics() -> Statistics {
+	auto lock = state.read();
+	return { lock->entries.size(), lock->size, lock->max_size, hits, misses };
+}
+
+} // namespace ivm
@@ -0,0 +1,38 @@
+#pragma once
+#include <v8.h>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace ivm {
+
+/**
+ * Process-wide store of v8 code cache data which is shared by every isolate. Entries are keyed by
+ * the exact source, its origin, and v8's cached data version, and the least recently used
+ * entries are evicted once the total size passes `max_size`. Entries can also be persisted as files
+ * in a directory so they survive restarts. The cache is disabled while `max_size` is 0 and there is
+ * no directory, which is the default.
+ */
+class CodeCache {
+	public:
+		struct Statistics {
+			size_t entries = 0;
+			size_t size = 0;
+			size_t max_size = 0;
+			size_t hits = 0;
+			size_t misses = 0;
+		};
+
+		static auto IsEnabled() -> bool;
+		// Returns data which v8 hasn't checked yet. Only misses are counted here, the caller reports
+		// what v8 made of the data with `RecordConsumed`.
+		static auto Lookup(const std::string& key) -> std::shared_ptr<v8::BackingStore>;
+		static void RecordConsumed(bool rejected);
+		static void Insert(const std::string& key, std::shared_ptr<v8::BackingStore> data);
+		static void SetMaxSize(size_t max_size);
+		// Returns false if `path` isn't a directory. An empty path stops persisting entries.
+		static auto SetDirectory(std::string path) -> bool;
+		static auto GetStatistics() -> Statistics;
+};
+
+} // namespace ivm
@@ -1,3 +1,4 @@
+#include "isolate/eval_cache.h"
 #include "isolate/run_with_timeout.h"
 #include "isolate/three_phase_task.h"
 #include "module/evaluation.h"
@@ -117,10 +118,25 @@ class EvalRunner : public CodeCompilerHolder, public ThreePhaseTask {
 			auto context = this->context.Deref();
 			Context::Scope context_scope{context};
 			IsolateEnvironment::HeapCheck heap_check{isolate, true};
-			auto source = GetSource();
-			auto script = RunWithAnnotatedErrors([&]() {
-				return Unmaybe(ScriptCompiler::Compile(context, source.get()));
-			});
+			auto script = [&]() {
+				auto* cache = isolate.GetEvalCache();
+				if (cache == nullptr) {
+					auto source = GetSource();
+					return RunWithAnnotatedErrors([&]() {
+						return Unmaybe(ScriptCompiler::Compile(context, source.get()));
+					});
+				}
+				auto key = GetEvalCacheKey(-1);
+				auto unbound_script = cache->Lookup(key);
+				if (unbound_script.IsEmpty()) {
+					auto source = GetSource();
+					unbound_script = RunWithAnnotatedErrors([&]() {
+						return Unmaybe(ScriptCompiler::CompileUnboundScript(isolate, source.get()));
+					});
+					cache->Insert(std::move(key), unbound_script);
+				}
+				return unbound_script->BindToCurrentContext();
+			}();
 
 			// Execute script and transfer out
 			Local<Value> script_result = RunWithTimeout(timeout_ms, [&]() {
@@ -186,23 +202,43 @@ class EvalClosureRunner : public CodeCompilerHolder, public ThreePhaseTask {
 			Context::Scope context_scope{context};
 			IsolateEnvironment::HeapCheck heap_check{isolate, true};
 
-			// Generate $0 ... $N argument names
-			std::vector<Local<String>> argument_names;
+			// Invoke `new Function` to compile script
 			size_t argc = argv.size();
-			argument_names.reserve(argc + 1);
-			for (size_t ii = 0; ii < argc; ++ii) {
-				argument_names.emplace_back(HandleCast<Local<String>>(std::string{"$"}+ std::to_string(ii)));
-			}
+			auto function = [&]() {
+				auto* cache = isolate.GetEvalCache();
+				std::string key;
+				if (cache != nullptr) {
+					key = GetEvalCacheKey(static_cast<int>(argc));
+					auto unbound_script = cache->Lookup(key);
+					if (!unbound_script.IsEmpty()) {
+						return Unmaybe(unbound_script->BindToCurrentContext()->Run(context)).As<Function>();
+					}
+				}
 
-			// Invoke `new Function` to compile script
-			auto source = GetSource();
-			auto function = RunWithAnnotatedErrors([&]() {
-				return Unmaybe(ScriptCompiler::CompileFunction(
-					context, source.get(),
-					argument_names.size(), argument_names.empty() ? nullptr : &argument_names[0],
-					0, nullptr
-				));
-			});
+				// Generate $0 ... $N argument names
+				std::vector<Local<String>> argument_names;
+				argument_names.reserve(argc + 1);
+				for (size_t ii = 0; ii < argc; ++ii) {
+					argument_names.emplace_back(HandleCast<Local<String>>(std::string{"$"}+ std::to_string(ii)));
+				}
+				auto source = GetSource();
+				auto function = RunWithAnnotatedErrors([&]() {
+					return Unmaybe(ScriptCompiler::CompileFunction(
+						context, source.get(),
+						argument_names.size(), argument_names.empty() ? nullptr : &argument_names[0],
+						0, nullptr
+					));
+				});
+
+				// A function from `CompileFunction` belongs to this context, so the cache gets a script which
+				// evaluates to the same function instead. It's only compiled once the code is known to be a
+				// valid function body so that errors are always reported by `CompileFunction`.
+				if (cache != nullptr) {
+					auto closure_source = GetClosureSource(argc);
+					cache->Insert(std::move(key), Unmaybe(ScriptCompiler::CompileUnboundScript(isolate, closure_source.get())));
+				}
+				return function;
+			}();
 
 			// Transfer arguments into this isolate
 			std::vector<Local<Value>> argv_transferred;
@@ -1,5 +1,6 @@
 #include "isolate/class_handle.h"
 #include "isolate/generic/read_option.h"
+#include "code_cache.h"
 #include "external_copy_handle.h"
 #include "evaluation.h"
 
@@ -33,12 +34,32 @@ ScriptOriginHolder::operator ScriptOrigin() const {
 	};
 }
 
+void ScriptOriginHolder::Hash(fnv1a_t& hash) const {
+	hash.update(filename);
+	hash.update(&column_offset, sizeof(column_offset));
+	hash.update(&line_offset, sizeof(line_offset));
+	hash.update(&is_module, sizeof(is_module));
+}
+
+void ScriptOriginHolder::AppendTo(std::string& key) const {
+	key += filename;
+	key += '\0';
+	key += std::to_string(line_offset) + ':' + std::to_string(column_offset) + (is_module ? 'm' : 's');
+}
+
+auto ScriptOriginHolder::ShiftColumns(int32_t delta) const -> ScriptOriginHolder {
+	auto copy = *this;
+	copy.column_offset -= delta;
+	return copy;
+}
+
 /**
  * CodeCompilerHolder implementation
  */
 CodeCompilerHolder::CodeCompilerHolder(Local<String> code_handle, MaybeLocal<Object> maybe_options, bool is_module) :
 		script_origin_holder{maybe_options, is_module},
 		code_string{ExternalCopyString{code_handle}},
+		eager{ReadOption<bool>(maybe_options, StringTable::Get().eager, {})},
 		produce_cached_data{ReadOption<bool>(maybe_options, StringTable::Get().produceCachedData, {})} {
 	// Read `cachedData`
 	auto maybe_cached_data = ReadOption<MaybeLocal<Object>>(maybe_options, StringTable::Get().cachedData, {});
@@ -74,6 +95,32 @@ auto CodeCompilerHolder::GetSource() -> std::unique_ptr<ScriptCompiler::Source>
 	);
 }
 
+auto CodeCompilerHolder::GetClosureSource(size_t argc) -> std::unique_ptr<ScriptCompiler::Source> {
+	std::string prefix = "(function (";
+	for (size_t ii = 0; ii < argc; ++ii) {
+		prefix += (ii == 0 ? "$" : ", $") + std::to_string(ii);
+	}
+	prefix += ") {";
+	// The body keeps its line and column numbers since the prefix is on the same line, and the suffix
+	// starts a new line in case the code ends in a comment
+	auto* isolate = Isolate::GetCurrent();
+	auto source = String::Concat(isolate, HandleCast<Local<String>>(prefix), GetSourceString());
+	source = String::Concat(isolate, source, HandleCast<Local<String>>("\n})"));
+	return std::make_unique<ScriptCompiler::Source>(
+		source,
+		ScriptOrigin{script_origin_holder.ShiftColumns(static_cast<int32_t>(prefix.size()))}
+	);
+}
+
+auto CodeCompilerHolder::GetEvalCacheKey(int argc) const -> std::string {
+	std::string key = std::to_string(argc);
+	key += '\0';
+	script_origin_holder.AppendTo(key);
+	key += '\0';
+	code_string.AppendTo(key);
+	return key;
+}
+
 auto CodeCompilerHolder::GetSourceString() -> v8::Local<v8::String> {
 	if (code_string_handle.IsEmpty()) {
 		code_string_handle = code_string.CopyIntoCheckHeap().As<String>();
@@ -82,15 +129,62 @@ auto CodeCompilerHolder::GetSourceString() -> v8::Local<v8::String> {
 }
 
 void CodeCompilerHolder::ResetSource() {
+	streaming_task.reset();
+	streamed_source.reset();
 	cached_data_in.reset();
 	code_string = {};
 }
 
-void CodeCompilerHolder::SaveCachedData(ScriptCompiler::CachedData* cached_data) {
-	if (cached_data != nullptr) {
-		cached_data_out = std::make_shared<ExternalCopyArrayBuffer>((void*)cached_data->data, cached_data->length);
-		cached_data->buffer_policy = ScriptCompiler::CachedData::BufferNotOwned;
-		delete cached_data;
+auto CodeCompilerHolder::GetCompileOptions() const -> ScriptCompiler::CompileOptions {
+	if (HasCachedData()) {
+		return ScriptCompiler::kConsumeCodeCache;
+	} else if (eager) {
+		return ScriptCompiler::kEagerCompile;
+	} else {
+		return ScriptCompiler::kNoCompileOptions;
+	}
+}
+
+void CodeCompilerHolder::StartStreaming(ScriptType type) {
+	streamed_source = code_string.GetStreamedSource();
+	streaming_task.reset(ScriptCompiler::StartStreaming(Isolate::GetCurrent(), streamed_source.get(), type, GetCompileOptions()));
+}
+
+void CodeCompilerHolder::ConsultCodeCache() {
+	if (supplied_cached_data || !CodeCache::IsEnabled()) {
+		return;
+	}
+	// The key is the exact source and origin, like the eval cache's, since the cache is shared with
+	// every other isolate in the process. Eagerly compiled data is kept apart so lazy and eager
+	// compiles don't get each other's cached data back from disk.
+	code_cache_key = V8::GetVersion();
+	code_cache_key += '\0';
+	code_cache_key += std::to_string(ScriptCompiler::CachedDataVersionTag());
+	code_cache_key += eager ? 'e' : 'l';
+	script_origin_holder.AppendTo(code_cache_key);
+	code_cache_key += '\0';
+	code_string.AppendTo(code_cache_key);
+	cached_data_in = CodeCache::Lookup(code_cache_key);
+	if (cached_data_in) {
+		cached_data_in_size = cached_data_in->ByteLength();
+	}
+}
+
+void CodeCompilerHolder::SaveCachedData(ScriptCompiler::CachedData* cached_data, bool store) {
+	auto backing_store = AdoptCachedData(cached_data);
+	if (!backing_store) {
+		return;
+	}
+	auto length = backing_store->ByteLength();
+	if (ShouldProduceCachedData()) {
+		// The caller gets a private copy when the original goes into the shared cache, since they
+		// can detach or modify it
+		cached_data_out = store ?
+			std::make_shared<ExternalCopyArrayBuffer>(backing_store->Data(), length) :
+			std::make_shared<ExternalCopyArrayBuffer>(backing_store);
+	}
+	if (store) {
+		CodeCache::Insert(code_cache_key, std::move(backing_store));
 	}
 }
 
@@ -105,4 +199,23 @@ void CodeCompilerHolder::WriteCompileResults(Local<Object> handle) {
 	}
 }
 
+/**
+ * AdoptCachedData implementation
+ */
+auto AdoptCachedData(ScriptCompiler::CachedData* cached_data) -> std::shared_ptr<BackingStore> {
+	if (cached_data == nullptr) {
+		return {};
+	}
+	// v8 allocates code cache data with new[], ownership moves to a backing store
+	auto length = static_cast<size_t>(cached_data->length);
+	auto* data = const_cast<uint8_t*>(cached_data->data);
+	cached_data->buffer_policy = ScriptCompiler::CachedData::BufferNotOwned;
+	delete cached_data;
+	return ArrayBuffer::NewBackingStore(
+		data, length,
+		[](void* data, size_t /*length*/, void* /*param*/) { delete[] static_cast<uint8_t*>(data); },
+		nullptr
+	);
+}
+
 } // namespace ivm
@@ -1,8 +1,10 @@
 #pragma once
+#include "code_cache.h"
 #include "isolate/generic/error.h"
 #include "isolate/generic/handle_cast.h"
 #include "external_copy/external_copy.h"
 #include "external_copy/string.h"
+#include "lib/hash.h"
 #include <v8.h>
 #include <memory>
 #include <string>
@@ -18,6 +20,10 @@ class ScriptOriginHolder {
 	public:
 		explicit ScriptOriginHolder(v8::MaybeLocal<v8::Object> maybe_options, bool is_module = false);
 		explicit operator v8::ScriptOrigin() const;
+		void Hash(fnv1a_t& hash) const;
+		void AppendTo(std::string& key) const;
+		// Copy of this origin for source which has `delta` extra characters in front of the first line
+		auto ShiftColumns(int32_t delta) const -> ScriptOriginHolder;
 
 	private:
 		std::string filename = "<isolated-vm>";
@@ -35,28 +41,88 @@ class CodeCompilerHolder {
 		CodeCompilerHolder(
 			v8::Local<v8::String> code_handle, v8::MaybeLocal<v8::Object> maybe_options, bool is_module = false);
 		auto DidSupplyCachedData() const { return supplied_cached_data; }
+		auto HasCachedData() const { return cached_data_in != nullptr; }
 		auto GetSource() -> std::unique_ptr<v8::ScriptCompiler::Source>;
+		// Source which evaluates to a function with parameters `$0` ... `$N` wrapping this code
+		auto GetClosureSource(size_t argc) -> std::unique_ptr<v8::ScriptCompiler::Source>;
 		auto GetSourceString() -> v8::Local<v8::String>;
+		// `kConsumeCodeCache` when there's cached data, otherwise `kEagerCompile` if `eager` was passed
+		auto GetCompileOptions() const -> v8::ScriptCompiler::CompileOptions;
 		void ResetSource();
-		void SaveCachedData(v8::ScriptCompiler::CachedData* cached_data);
 		void SetCachedDataRejected(bool rejected) { cached_data_rejected = rejected; }
 		auto ShouldProduceCachedData() const { return produce_cached_data && (!supplied_cached_data || cached_data_rejected); }
 		void WriteCompileResults(v8::Local<v8::Object> handle);
 
+		/**
+		 * If the process-wide code cache is enabled and no `cachedData` was supplied then this looks up
+		 * cached data for this source. Must be called before `GetSource`.
+		 */
+		void ConsultCodeCache();
+
+		/**
+		 * Key for the per-isolate `EvalCache`. `argc` is the number of closure arguments, or -1 for
+		 * plain `eval`.
+		 */
+		auto GetEvalCacheKey(int argc) const -> std::string;
+
+		/**
+		 * Called after compilation. Records whether the supplied cached data was accepted, and produces
+		 * new cached data if it was requested or if the process-wide code cache needs it.
+		 */
+		template <class Unbound>
+		void UpdateCachedData(v8::ScriptCompiler::Source& source, v8::Local<Unbound> unbound) {
+			UpdateCachedData(HasCachedData() && source.GetCachedData()->rejected, unbound);
+		}
+
+		template <class Unbound>
+		void UpdateCachedData(bool rejected, v8::Local<Unbound> unbound) {
+			if (DidSupplyCachedData()) {
+				SetCachedDataRejected(rejected);
+			} else if (HasCachedData()) {
+				CodeCache::RecordConsumed(rejected);
+			}
+			bool store = !code_cache_key.empty() && (!HasCachedData() || rejected);
+			if (store || ShouldProduceCachedData()) {
+				SaveCachedData(v8::ScriptCompiler::CreateCodeCache(unbound), store);
+			}
+		}
+
+		/**
+		 * Off-thread compilation. `StartStreaming` is called in the isolate, then `RunStreaming` does the
+		 * parsing and compiling from any thread. The result is picked up in the isolate by passing
+		 * `GetStreamedSource()` to v8. Streaming never consumes cached data.
+		 */
+		void StartStreaming(v8::ScriptType type);
+		void RunStreaming() { streaming_task->Run(); }
+		auto GetStreamedSource() { return streamed_source.get(); }
+		auto GetScriptOrigin() const { return v8::ScriptOrigin{script_origin_holder}; }
+
 	private:
 		auto GetCachedData() const -> std::unique_ptr<v8::ScriptCompiler::CachedData>;
+		void SaveCachedData(v8::ScriptCompiler::CachedData* cached_data, bool store);
 
 		ScriptOriginHolder script_origin_holder;
 		ExternalCopyString code_string;
 		std::shared_ptr<ExternalCopyArrayBuffer> cached_data_out;
 		std::shared_ptr<v8::BackingStore> cached_data_in;
+		std::unique_ptr<v8::ScriptCompiler::StreamedSource> streamed_source;
+		std::unique_ptr<v8::ScriptCompiler::ScriptStreamingTask> streaming_task;
 		mutable v8::Local<v8::String> code_string_handle;
+		// Set when the process-wide code cache was consulted
+		std::string code_cache_key;
 		size_t cached_data_in_size = 0;
 		bool cached_data_rejected = false;
+		bool eager = false;
 		bool produce_cached_data = false;
 		bool supplied_cached_data = false;
 };
 
+/**
+ * Takes ownership of code cache data produced by v8 and returns it as a backing store, or nullptr if
+ * v8 didn't produce anything.
+ */
+auto AdoptCachedData(v8::ScriptCompiler::CachedData* cached_data) -> std::shared_ptr<v8::BackingStore>;
+
 /**
  * Run a lambda which invokes the v8 compiler and annotate the exception with source / line number
  * if it throws.
@@ -1,17 +1,23 @@
+#include "external_copy/external_copy.h"
 #include "isolate/environment.h"
+#include "isolate/memory_governor.h"
 #include "isolate/node_wrapper.h"
 #include "isolate/platform_delegate.h"
 #include "isolate/scheduler.h"
 #include "isolate/util.h"
 #include "lib/lockable.h"
 #include "callback.h"
+#include "code_cache.h"
 #include "context_handle.h"
 #include "external_copy_handle.h"
+#include "isolate_group_handle.h"
 #include "isolate_handle.h"
+#include "isolate_pool_handle.h"
 #include "lib_handle.h"
 #include "native_module_handle.h"
 #include "reference_handle.h"
 #include "script_handle.h"
+#include "wasm_cache.h"
 
 #include <memory>
 #include <mutex>
@@ -42,12 +48,113 @@ class LibraryHandle : public TransferableHandle {
 				"Context", ClassHandle::GetFunctionTemplate<ContextHandle>(),
 				"ExternalCopy", ClassHandle::GetFunctionTemplate<ExternalCopyHandle>(),
 				"Isolate", ClassHandle::GetFunctionTemplate<IsolateHandle>(),
+				"IsolateGroup", ClassHandle::GetFunctionTemplate<IsolateGroupHandle>(),
+				"IsolatePool", ClassHandle::GetFunctionTemplate<IsolatePoolHandle>(),
 				"NativeModule", ClassHandle::GetFunctionTemplate<NativeModuleHandle>(),
 				"Reference", ClassHandle::GetFunctionTemplate<ReferenceHandle>(),
-				"Script", ClassHandle::GetFunctionTemplate<ScriptHandle>()
+				"Script", ClassHandle::GetFunctionTemplate<ScriptHandle>(),
+				"getCodeCacheStatistics", MemberFunction<decltype(&LibraryHandle::GetCodeCacheStatistics), &LibraryHandle::GetCodeCacheStatistics>{},
+				"getWasmCacheStatistics", MemberFunction<decltype(&LibraryHandle::GetWasmCacheStatistics), &LibraryHandle::GetWasmCacheStatistics>{},
+				"setCodeCache", MemberFunction<decltype(&LibraryHandle::SetCodeCache), &LibraryHandle::SetCodeCache>{},
+				"setCodeCacheDirectory", MemberFunction<decltype(&LibraryHandle::SetCodeCacheDirectory), &LibraryHandle::SetCodeCacheDirectory>{},
+				"setMemoryGovernor", MemberFunction<decltype(&LibraryHandle::SetMemoryGovernor), &LibraryHandle::SetMemoryGovernor>{},
+				"setWasmCache", MemberFunction<decltype(&LibraryHandle::SetWasmCache), &LibraryHandle::SetWasmCache>{},
+				"trimMemory", MemberFunction<decltype(&LibraryHandle::TrimMemory), &LibraryHandle::TrimMemory>{}
 			));
 		}
 
+		auto SetMemoryGovernor(MaybeLocal<Object> maybe_options) -> Local<Value> {
+			auto& env = IsolateEnvironment::GetCurrent();
+			if (!env.IsDefault()) {
+				throw RuntimeGenericError("`setMemoryGovernor` may only be called from the default isolate");
+			}
+			Local<Object> options;
+			if (maybe_options.ToLocal(&options)) {
+				auto moderate = ReadOption<double>(options, StringTable::Get().moderate, 0);
+				auto critical = ReadOption<double>(options, StringTable::Get().critical, 0);
+				auto interval = ReadOption<double>(options, StringTable::Get().interval, 1000);
+				if (moderate <= 0 && critical <= 0) {
+					throw RuntimeTypeError("`moderate` or `critical` is required");
+				} else if (interval < 1) {
+					throw RuntimeRangeError("`interval` must be at least 1");
+				}
+				env.SetMemoryGovernor(std::make_unique<MemoryGovernor>(
+					env,
+					static_cast<size_t>(moderate * 1024 * 1024),
+					static_cast<size_t>(critical * 1024 * 1024),
+					static_cast<uint32_t>(interval)
+				));
+			} else {
+				env.SetMemoryGovernor({});
+			}
+			return Undefined(Isolate::GetCurrent());
+		}
+
+		auto SetCodeCache(MaybeLocal<Object> maybe_options) -> Local<Value> {
+			auto max_size = ReadOption<double>(maybe_options, StringTable::Get().maxSize, 0);
+			if (max_size < 0) {
+				throw RuntimeRangeError("`maxSize` must not be negative");
+			}
+			CodeCache::SetMaxSize(static_cast<size_t>(max_size * 1024 * 1024));
+			return Undefined(Isolate::GetCurrent());
+		}
+
+		auto SetCodeCacheDirectory(MaybeLocal<String> maybe_path) -> Local<Value> {
+			Local<String> path_handle;
+			std::string path;
+			if (maybe_path.ToLocal(&path_handle)) {
+				path = HandleCast<std::string>(path_handle);
+				if (path.empty()) {
+					throw RuntimeTypeError("`path` must not be empty");
+				}
+			}
+			if (!CodeCache::SetDirectory(std::move(path))) {
+				throw RuntimeGenericError("`path` is not a directory");
+			}
+			return Undefined(Isolate::GetCurrent());
+		}
+
+		auto GetCodeCacheStatistics() -> Local<Value> {
+			auto stats = CodeCache::GetStatistics();
+			auto* isolate = Isolate::GetCurrent();
+			auto context = isolate->GetCurrentContext();
+			auto& strings = StringTable::Get();
+			Local<Object> ret = Object::New(isolate);
+			Unmaybe(ret->Set(context, strings.entries, Number::New(isolate, stats.entries)));
+			Unmaybe(ret->Set(context, strings.size, Number::New(isolate, stats.size)));
+			Unmaybe(ret->Set(context, strings.maxSize, Number::New(isolate, stats.max_size)));
+			Unmaybe(ret->Set(context, strings.hits, Number::New(isolate, stats.hits)));
+			Unmaybe(ret->Set(context, strings.misses, Number::New(isolate, stats.misses)));
+			return ret;
+		}
+
+		auto SetWasmCache(MaybeLocal<Object> maybe_options) -> Local<Value> {
+			auto max_entries = ReadOption<double>(maybe_options, StringTable::Get().maxEntries, 0);
+			if (max_entries < 0) {
+				throw RuntimeRangeError("`maxEntries` must not be negative");
+			}
+			WasmCache::SetMaxEntries(static_cast<size_t>(max_entries));
+			return Undefined(Isolate::GetCurrent());
+		}
+
+		auto GetWasmCacheStatistics() -> Local<Value> {
+			auto stats = WasmCache::GetStatistics();
+			auto* isolate = Isolate::GetCurrent();
+			auto context = isolate->GetCurrentContext();
+			auto& strings = StringTable::Get();
+			Local<Object> ret = Object::New(isolate);
+			Unmaybe(ret->Set(context, strings.entries, Number::New(isolate, stats.entries)));
+			Unmaybe(ret->Set(context, strings.maxEntries, Number::New(isolate, stats.max_entries)));
+			Unmaybe(ret->Set(context, strings.hits, Number::New(isolate, stats.hits)));
+			Unmaybe(ret->Set(context, strings.misses, Number::New(isolate, stats.misses)));
+			return ret;
+		}
+
+		auto TrimMemory() -> Local<Value> {
+			MemoryGovernor::TrimMemory(Executor::GetDefaultEnvironment());
+			return Undefined(Isolate::GetCurrent());
+		}
+
 		auto TransferOut() -> std::unique_ptr<Transferable> final {
 			return std::make_unique<LibraryHandleTransferable>();
 		}
@@ -68,6 +175,8 @@ class LibraryHandle : public TransferableHandle {
 			freeze("Context");
 			freeze("ExternalCopy");
 			freeze("Isolate");
+			freeze("IsolateGroup");
+			freeze("IsolatePool");
 			freeze("NativeModule");
 			freeze("Reference");
 			freeze("Script");
@@ -112,6 +221,10 @@ void init(Local<Object> target) {
 
 	node::AddEnvironmentCleanupHook(isolate, [](void* param) {
 		auto* isolate = static_cast<v8::Isolate*>(param);
+		if (default_isolates->read()->size() == 1) {
+			WasmCache::Clear();
+			ExternalCopyWasmModule::ReleaseAll();
+		}
 		auto it = default_isolates->read()->find(isolate);
 		it->second.holder->Release();
 		it->second.dispose_wait->Join();
@@ -0,0 +1,56 @@
+#include "isolate_group_handle.h"
+#include "isolate/memory_group.h"
+
+using namespace v8;
+using std::shared_ptr;
+using std::unique_ptr;
+
+namespace ivm {
+
+/**
+ * Transferable wrapper
+ */
+IsolateGroupHandle::IsolateGroupTransferable::IsolateGroupTransferable(shared_ptr<MemoryGroup> group) : group{std::move(group)} {}
+
+auto IsolateGroupHandle::IsolateGroupTransferable::TransferIn() -> Local<Value> {
+	return ClassHandle::NewInstance<IsolateGroupHandle>(group);
+}
+
+/**
+ * IsolateGroupHandle implementation
+ */
+IsolateGroupHandle::IsolateGroupHandle(shared_ptr<MemoryGroup> group) : group{std::move(group)} {}
+
+auto IsolateGroupHandle::Definition() -> Local<FunctionTemplate> {
+	return Inherit<TransferableHandle>(MakeClass(
+		"IsolateGroup", ConstructorFunction<decltype(&IsolateGroupHandle::New), &IsolateGroupHandle::New>{},
+		"memoryLimit", MemberAccessor<decltype(&IsolateGroupHandle::GetMemoryLimit), &IsolateGroupHandle::GetMemoryLimit>{},
+		"memoryUsage", MemberAccessor<decltype(&IsolateGroupHandle::GetMemoryUsage), &IsolateGroupHandle::GetMemoryUsage>{}
+	));
+}
+
+auto IsolateGroupHandle::New(MaybeLocal<Object> maybe_options) -> unique_ptr<IsolateGroupHandle> {
+	auto memory_limit = ReadOption<double>(maybe_options, StringTable::Get().memoryLimit, 0);
+	if (memory_limit < 8) {
+		throw RuntimeGenericError("`memoryLimit` must be at least 8");
+	}
+	return std::make_unique<IsolateGroupHandle>(
+		std::make_shared<MemoryGroup>(static_cast<size_t>(memory_limit * 1024 * 1024)));
+}
+
+auto IsolateGroupHandle::TransferOut() -> unique_ptr<Transferable> {
+	return std::make_unique<IsolateGroupTransferable>(group);
+}
+
+/**
+ * JS API functions
+ */
+auto IsolateGroupHandle::GetMemoryLimit() -> Local<Value> {
+	return Number::New(Isolate::GetCurrent(), static_cast<double>(group->GetLimit()));
+}
+
+auto IsolateGroupHandle::GetMemoryUsage() -> Local<Value> {
+	return Number::New(Isolate::GetCurrent(), static_cast<double>(group->GetUsage()));
+}
+
+} // namespace ivm
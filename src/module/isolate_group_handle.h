@@ -0,0 +1,36 @@
+#pragma once
+#include "transferable.h"
+#include <v8.h>
+#include <memory>
+
+namespace ivm {
+
+class MemoryGroup;
+
+/**
+ * Memory budget which can be shared between many isolates
+ */
+class IsolateGroupHandle : public TransferableHandle {
+	private:
+		std::shared_ptr<MemoryGroup> group;
+
+		class IsolateGroupTransferable : public Transferable {
+			private:
+				std::shared_ptr<MemoryGroup> group;
+			public:
+				explicit IsolateGroupTransferable(std::shared_ptr<MemoryGroup> group);
+				auto TransferIn() -> v8::Local<v8::Value> final;
+		};
+
+	public:
+		explicit IsolateGroupHandle(std::shared_ptr<MemoryGroup> group);
+		static auto Definition() -> v8::Local<v8::FunctionTemplate>;
+		static auto New(v8::MaybeLocal<v8::Object> maybe_options) -> std::unique_ptr<IsolateGroupHandle>;
+		auto TransferOut() -> std::unique_ptr<Transferable> final;
+
+		auto GetMemoryGroup() const -> const std::shared_ptr<MemoryGroup>& { return group; }
+		auto GetMemoryLimit() -> v8::Local<v8::Value>;
+		auto GetMemoryUsage() -> v8::Local<v8::Value>;
+};
+
+} // namespace ivm
@@ -1,25 +1,44 @@
 #include "isolate_handle.h"
 #include "context_handle.h"
 #include "external_copy_handle.h"
+#include "isolate_group_handle.h"
 #include "isolate/holder.h"
 #include "script_handle.h"
 #include "module_handle.h"
 #include "session_handle.h"
+#include "wasm_cache.h"
 #include "external_copy/external_copy.h"
 #include "lib/lockable.h"
 #include "isolate/allocator.h"
 #include "isolate/functor_runners.h"
+#include "isolate/memory_group.h"
 #include "isolate/platform_delegate.h"
 #include "isolate/remote_handle.h"
 #include "isolate/three_phase_task.h"
 #include "isolate/v8_version.h"
+#include "lib/file.h"
+#include "lib/hash.h"
+#include "lib/thread_pool.h"
 #include "module/evaluation.h"
 #include "v8-platform.h"
 #include "v8-profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <deque>
+#include <fstream>
+#include <future>
+#include <limits>
+#include <list>
 #include <memory>
 #include <iostream>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 using namespace v8;
 using v8::CpuProfile;
@@ -46,11 +65,16 @@ static std::unique_ptr<ClassHandle> IsolateHandle_New_Wrapper(v8::MaybeLocal<v8:
 auto IsolateHandle::Definition() -> Local<FunctionTemplate> {
 	return Inherit<TransferableHandle>(MakeClass(
 		"Isolate", ConstructorFunction<decltype(&IsolateHandle_New_Wrapper), &IsolateHandle_New_Wrapper>{},
+		"create", FreeFunction<decltype(&Create), &Create>{},
 		"createSnapshot", FreeFunction<decltype(&CreateSnapshot), &CreateSnapshot>{},
+		"createSnapshotAsync", FreeFunction<decltype(&CreateSnapshotAsync), &CreateSnapshotAsync>{},
 		"compileScript", MemberFunction<decltype(&IsolateHandle::CompileScript<1>), &IsolateHandle::CompileScript<1>>{},
 		"compileScriptSync", MemberFunction<decltype(&IsolateHandle::CompileScript<0>), &IsolateHandle::CompileScript<0>>{},
 		"compileModule", MemberFunction<decltype(&IsolateHandle::CompileModule<1>), &IsolateHandle::CompileModule<1>>{},
 		"compileModuleSync", MemberFunction<decltype(&IsolateHandle::CompileModule<0>), &IsolateHandle::CompileModule<0>>{},
+		"compileModules", MemberFunction<decltype(&IsolateHandle::CompileModules<1>), &IsolateHandle::CompileModules<1>>{},
+		"compileModulesSync", MemberFunction<decltype(&IsolateHandle::CompileModules<0>), &IsolateHandle::CompileModules<0>>{},
+		"compileWasm", MemberFunction<decltype(&IsolateHandle::CompileWasm), &IsolateHandle::CompileWasm>{},
 		"cpuTime", MemberAccessor<decltype(&IsolateHandle::GetCpuTime), &IsolateHandle::GetCpuTime>{},
 		"createContext", MemberFunction<decltype(&IsolateHandle::CreateContext<1>), &IsolateHandle::CreateContext<1>>{},
 		"createContextSync", MemberFunction<decltype(&IsolateHandle::CreateContext<0>), &IsolateHandle::CreateContext<0>>{},
@@ -58,33 +82,74 @@ auto IsolateHandle::Definition() -> Local<FunctionTemplate> {
 		"dispose", MemberFunction<decltype(&IsolateHandle::Dispose), &IsolateHandle::Dispose>{},
 		"getHeapStatistics", MemberFunction<decltype(&IsolateHandle::GetHeapStatistics<1>), &IsolateHandle::GetHeapStatistics<1>>{},
 		"getHeapStatisticsSync", MemberFunction<decltype(&IsolateHandle::GetHeapStatistics<0>), &IsolateHandle::GetHeapStatistics<0>>{},
+		"getStatsSnapshot", MemberFunction<decltype(&IsolateHandle::GetStatsSnapshot), &IsolateHandle::GetStatsSnapshot>{},
+		"hibernate", MemberFunction<decltype(&IsolateHandle::Hibernate<1>), &IsolateHandle::Hibernate<1>>{},
+		"hibernateSync", MemberFunction<decltype(&IsolateHandle::Hibernate<0>), &IsolateHandle::Hibernate<0>>{},
 		"isDisposed", MemberAccessor<decltype(&IsolateHandle::IsDisposedGetter), &IsolateHandle::IsDisposedGetter>{},
+		"isHibernating", MemberAccessor<decltype(&IsolateHandle::IsHibernatingGetter), &IsolateHandle::IsHibernatingGetter>{},
 		"referenceCount", MemberAccessor<decltype(&IsolateHandle::GetReferenceCount), &IsolateHandle::GetReferenceCount>{},
 		"wallTime", MemberAccessor<decltype(&IsolateHandle::GetWallTime), &IsolateHandle::GetWallTime>{},
 		"startCpuProfiler", MemberFunction<decltype(&IsolateHandle::StartCpuProfiler), &IsolateHandle::StartCpuProfiler>{},
-		"stopCpuProfiler", MemberFunction<decltype(&IsolateHandle::StopCpuProfiler<1>), &IsolateHandle::StopCpuProfiler<1>>{}
+		"stopCpuProfiler", MemberFunction<decltype(&IsolateHandle::StopCpuProfiler<1>), &IsolateHandle::StopCpuProfiler<1>>{},
+		"unregisterModule", MemberFunction<decltype(&IsolateHandle::UnregisterModule<1>), &IsolateHandle::UnregisterModule<1>>{},
+		"unregisterModuleSync", MemberFunction<decltype(&IsolateHandle::UnregisterModule<0>), &IsolateHandle::UnregisterModule<0>>{}
 	));
 }
 
 /**
- * Create a new Isolate. It all starts here!
+ * Parse options for a new isolate
  */
-auto IsolateHandle::New(MaybeLocal<Object> maybe_options) -> unique_ptr<ClassHandle> {
-	shared_ptr<v8::BackingStore> snapshot_blob;
-	RemoteHandle<Function> error_handler;
-	size_t snapshot_blob_length = 0;
-	size_t memory_limit = 128;
-	bool inspector = false;
-
-	// Parse options
+IsolateOptions::IsolateOptions(MaybeLocal<Object> maybe_options) {
 	Local<Object> options;
 	if (maybe_options.ToLocal(&options)) {
 
 		// Check memory limits
-		memory_limit = ReadOption<double>(options, "memoryLimit", 128);
+		auto memory_limit = ReadOption<double>(options, "memoryLimit", 128);
 		if (memory_limit < 8) {
 			throw RuntimeGenericError("`memoryLimit` must be at least 8");
 		}
+		params.memory_limit_in_mb = memory_limit;
+		auto soft_memory_limit = ReadOption<double>(options, StringTable::Get().softMemoryLimit, 0);
+		if (soft_memory_limit >= memory_limit) {
+			throw RuntimeRangeError("`softMemoryLimit` must be less than `memoryLimit`");
+		}
+		this->soft_memory_limit = soft_memory_limit * 1024 * 1024;
+
+		// Initial heap sizes
+		auto initial_old_generation_size = ReadOption<double>(options, StringTable::Get().initialOldGenerationSize, 0);
+		auto initial_young_generation_size = ReadOption<double>(options, StringTable::Get().initialYoungGenerationSize, 0);
+		if (initial_old_generation_size < 0 || initial_old_generation_size > memory_limit) {
+			throw RuntimeRangeError("`initialOldGenerationSize` must be between 0 and `memoryLimit`");
+		}
+		if (initial_young_generation_size < 0 || initial_young_generation_size > memory_limit) {
+			throw RuntimeRangeError("`initialYoungGenerationSize` must be between 0 and `memoryLimit`");
+		}
+		params.initial_old_generation_size_in_mb = initial_old_generation_size;
+		params.initial_young_generation_size_in_mb = initial_young_generation_size;
+		params.workload = ReadOption<std::string>(options, StringTable::Get().workload, {});
+		params.lazy_default_context = ReadOption<bool>(options, StringTable::Get().lazyDefaultContext, false);
+
+		// Join shared memory budget
+		auto maybe_group = ReadOption<MaybeLocal<Object>>(options, StringTable::Get().group, {});
+		Local<Object> group_handle;
+		if (maybe_group.ToLocal(&group_handle)) {
+			auto* group = ClassHandle::Unwrap<IsolateGroupHandle>(group_handle);
+			if (group == nullptr) {
+				throw RuntimeTypeError("`group` must be an IsolateGroup");
+			}
+			auto memory_floor = ReadOption<double>(options, StringTable::Get().memoryFloor, 0);
+			if (memory_floor > memory_limit) {
+				throw RuntimeRangeError("`memoryFloor` must not be greater than `memoryLimit`");
+			}
+			memory_group = group->GetMemoryGroup();
+			this->memory_floor = memory_floor * 1024 * 1024;
+		}
+
+		auto maybe_soft_handler = ReadOption<MaybeLocal<Function>>(options, StringTable::Get().onSoftMemoryLimit, {});
+		Local<Function> soft_handler_local;
+		if (maybe_soft_handler.ToLocal(&soft_handler_local)) {
+			soft_memory_limit_handler = RemoteHandle<Function>{soft_handler_local};
+		}
 
 		// Set snapshot
 		auto maybe_snapshot = ReadOption<MaybeLocal<Object>>(options, StringTable::Get().snapshot, {});
@@ -94,15 +159,33 @@ auto IsolateHandle::New(MaybeLocal<Object> maybe_options) -> unique_ptr<ClassHan
 			if (copy_handle != nullptr) {
 				ExternalCopyArrayBuffer* copy_ptr = dynamic_cast<ExternalCopyArrayBuffer*>(copy_handle->GetValue().get());
 				if (copy_ptr != nullptr) {
-					snapshot_blob = copy_ptr->Acquire();
-					snapshot_blob_length = snapshot_blob->ByteLength();
+					params.snapshot_blob = copy_ptr->Acquire();
+					params.snapshot_length = params.snapshot_blob->ByteLength();
 				}
 			}
-			if (!snapshot_blob) {
+			if (!params.snapshot_blob) {
 				throw RuntimeTypeError("`snapshot` must be an ExternalCopy to ArrayBuffer");
 			}
 		}
 
+		auto idle_delay = ReadOption<double>(options, StringTable::Get().idleCollectionDelay, 0);
+		if (idle_delay < 0) {
+			throw RuntimeRangeError("`idleCollectionDelay` must not be negative");
+		}
+		idle_collection_delay = static_cast<uint32_t>(idle_delay);
+
+		auto context_pool_size = ReadOption<double>(options, StringTable::Get().contextPoolSize, 0);
+		if (context_pool_size < 0) {
+			throw RuntimeRangeError("`contextPoolSize` must not be negative");
+		}
+		this->context_pool_size = context_pool_size;
+
+		auto eval_cache_size = ReadOption<double>(options, StringTable::Get().evalCacheSize, 0);
+		if (eval_cache_size < 0) {
+			throw RuntimeRangeError("`evalCacheSize` must not be negative");
+		}
+		this->eval_cache_size = eval_cache_size;
+
 		// Check inspector flag
 		inspector = ReadOption<bool>(options, StringTable::Get().inspector, false);
 
@@ -112,18 +195,88 @@ auto IsolateHandle::New(MaybeLocal<Object> maybe_options) -> unique_ptr<ClassHan
 			error_handler = RemoteHandle<Function>{error_handler_local};
 		}
 	}
+}
 
-	// Return isolate handle
-	auto holder = IsolateEnvironment::New(memory_limit, std::move(snapshot_blob), snapshot_blob_length);
-	auto env = holder->GetIsolate();
+void IsolateOptions::Configure(IsolateHolder& holder) const {
+	// Reserve group budget first since it may throw
+	std::unique_ptr<MemoryGroup::Member> member;
+	if (memory_group) {
+		member = std::make_unique<MemoryGroup::Member>(memory_group, memory_floor);
+	}
+	auto env = holder.GetIsolate();
+	env->GetIsolate()->SetHostImportModuleDynamicallyCallback(ModuleHandle::ImportModuleDynamically);
 	env->GetIsolate()->SetHostInitializeImportMetaObjectCallback(ModuleHandle::InitializeImportMeta);
+	env->GetIsolate()->SetWasmModuleCallback(WasmCache::ModuleCallback);
 	env->error_handler = error_handler;
+	env->soft_memory_limit_handler = soft_memory_limit_handler;
+	env->SetSoftMemoryLimit(soft_memory_limit);
+	env->SetMemoryGroup(std::move(member));
+	env->SetIdleCollectionDelay(idle_collection_delay);
+	env->SetContextPoolSize(context_pool_size);
+	env->SetEvalCacheSize(eval_cache_size);
 	if (inspector) {
 		env->EnableInspectorAgent();
 	}
+}
+
+/**
+ * Create a new Isolate. It all starts here!
+ */
+auto IsolateHandle::New(MaybeLocal<Object> maybe_options) -> unique_ptr<ClassHandle> {
+	IsolateOptions options{maybe_options};
+	auto holder = IsolateEnvironment::New(options.params);
+	options.Configure(*holder);
 	return std::make_unique<IsolateHandle>(holder);
 }
 
+/**
+ * Same as `new Isolate` except the isolate is built on a background thread
+ */
+auto IsolateHandle::Create(MaybeLocal<Object> maybe_options) -> Local<Value> {
+	struct ResolveTask : Runnable {
+		ResolveTask(std::shared_ptr<IsolateOptions> options, RemoteTuple<Promise::Resolver, Context> resolver, shared_ptr<IsolateHolder> holder) :
+			options{std::move(options)}, resolver{std::move(resolver)}, holder{std::move(holder)} {}
+
+		void Run() final {
+			auto context = this->resolver.Deref<1>();
+			Context::Scope context_scope{context};
+			auto resolver = this->resolver.Deref<0>();
+			FunctorRunners::RunCatchValue([&]() {
+				options->Configure(*holder);
+				Unmaybe(resolver->Resolve(context, ClassHandle::NewInstance<IsolateHandle>(holder)));
+			}, [&](Local<Value> error) {
+				holder->Dispose();
+				Unmaybe(resolver->Reject(context, error));
+			});
+			Isolate::GetCurrent()->PerformMicrotaskCheckpoint();
+			// Release the ref taken by `Create`
+			LockedScheduler::DecrementUvRefForIsolate(IsolateEnvironment::GetCurrentHolder());
+		}
+
+		std::shared_ptr<IsolateOptions> options;
+		RemoteTuple<Promise::Resolver, Context> resolver;
+		shared_ptr<IsolateHolder> holder;
+	};
+
+	if (!IsolateEnvironment::GetCurrent().IsDefault()) {
+		throw RuntimeGenericError("`Isolate.create` may only be called from the default isolate");
+	}
+	auto options = std::make_shared<IsolateOptions>(maybe_options);
+	auto* isolate = Isolate::GetCurrent();
+	auto context = isolate->GetCurrentContext();
+	auto resolver = Unmaybe(Promise::Resolver::New(context));
+	auto default_holder = IsolateEnvironment::GetCurrentHolder();
+
+	// Holding a ref keeps the process alive until the isolate is ready, and also allows the
+	// background thread to wake the default isolate
+	LockedScheduler::IncrementUvRefForIsolate(default_holder);
+	auto remote = std::make_shared<RemoteTuple<Promise::Resolver, Context>>(resolver, context);
+	IsolateEnvironment::NewInBackground(options->params, [=](shared_ptr<IsolateHolder> holder) {
+		default_holder->ScheduleTask(std::make_unique<ResolveTask>(options, std::move(*remote), std::move(holder)), false, true);
+	});
+	return resolver->GetPromise();
+}
+
 auto IsolateHandle::TransferOut() -> unique_ptr<Transferable> {
 	return std::make_unique<IsolateHandleTransferable>(isolate);
 }
@@ -133,11 +286,21 @@ auto IsolateHandle::TransferOut() -> unique_ptr<Transferable> {
  */
 struct CreateContextRunner : public ThreePhaseTask {
 	bool enable_inspector = false;
+	std::optional<size_t> snapshot_index;
 	RemoteHandle<Context> context;
 	RemoteHandle<Value> global;
 
 	explicit CreateContextRunner(MaybeLocal<Object>& maybe_options) {
 		enable_inspector = ReadOption<bool>(maybe_options, StringTable::Get().inspector, false);
+		auto maybe_index = ReadOption<Local<Number>>(maybe_options, StringTable::Get().snapshotIndex, {});
+		if (!maybe_index.IsEmpty()) {
+			// NaN fails every comparison, so it's rejected along with negative, fractional, and huge values
+			double index = maybe_index->Value();
+			if (!(index >= 0 && index <= std::numeric_limits<uint32_t>::max()) || index != std::trunc(index)) {
+				throw RuntimeRangeError("`snapshotIndex` must be a non-negative integer");
+			}
+			snapshot_index = static_cast<size_t>(index);
+		}
 	}
 
 	void Phase2() final {
@@ -146,7 +309,7 @@ struct CreateContextRunner : public ThreePhaseTask {
 			void operator() (v8::Persistent<Context>& context) const {
 				auto& env = IsolateEnvironment::GetCurrent();
 				context.Reset();
-				env.GetIsolate()->ContextDisposedNotification();
+				env.ContextDisposed();
 			}
 		};
 
@@ -160,7 +323,17 @@ struct CreateContextRunner : public ThreePhaseTask {
 
 		// Make a new context and setup shared pointers
 		IsolateEnvironment::HeapCheck heap_check{env, true};
-		Local<Context> context_handle = env.NewContext();
+		Local<Context> context_handle;
+		if (snapshot_index) {
+			Context::Scope context_scope{env.DefaultContext()}; // Needed to throw
+			context_handle = env.NewContextFromSnapshot(*snapshot_index);
+		} else {
+			context_handle = env.TakeSpareContext();
+			if (context_handle.IsEmpty()) {
+				context_handle = env.NewContext();
+			}
+		}
+		WasmCache::InstallCompile(context_handle);
 		if (enable_inspector) {
 			env.GetInspectorAgent()->ContextCreated(context_handle, "<isolated-vm>");
 		}
@@ -191,30 +364,48 @@ struct CompileScriptRunner : public CodeCompilerHolder, public ThreePhaseTask {
 	void Phase2() final {
 		// Compile in second isolate and return UnboundScript persistent
 		auto& isolate = IsolateEnvironment::GetCurrent();
+		ConsultCodeCache();
+		if (!HasCachedData() && DeferToBackground()) {
+			StartStreaming(ScriptType::kClassic);
+			return;
+		}
 		Context::Scope context_scope(isolate.DefaultContext());
 		IsolateEnvironment::HeapCheck heap_check{isolate, true};
 		auto source = GetSource();
-		ScriptCompiler::CompileOptions compile_options = ScriptCompiler::kNoCompileOptions;
-		if (DidSupplyCachedData()) {
-			compile_options = ScriptCompiler::kConsumeCodeCache;
-		}
-		script = RemoteHandle<UnboundScript>{RunWithAnnotatedErrors(
+		auto compile_options = GetCompileOptions();
+		auto unbound_script = RunWithAnnotatedErrors(
 			[&isolate, &source, compile_options]() { return Unmaybe(ScriptCompiler::CompileUnboundScript(isolate, source.get(), compile_options)); }
-		)};
+		);
+		script = RemoteHandle<UnboundScript>{unbound_script};
 
 		// Check cached data flags
-		if (DidSupplyCachedData()) {
-			SetCachedDataRejected(source->GetCachedData()->rejected);
-		}
-		if (ShouldProduceCachedData()) {
-			ScriptCompiler::CachedData* cached_data = ScriptCompiler::CreateCodeCache(script.Deref());
-			assert(cached_data != nullptr);
-			SaveCachedData(cached_data);
-		}
+		UpdateCachedData(*source, unbound_script);
+		ResetSource();
+		heap_check.Epilogue();
+	}
+
+	void Phase2Background() final {
+		RunStreaming();
+	}
+
+	void Phase2Finalize() final {
+		auto& isolate = IsolateEnvironment::GetCurrent();
+		auto context = isolate.DefaultContext();
+		Context::Scope context_scope(context);
+		IsolateEnvironment::HeapCheck heap_check{isolate, true};
+		auto unbound_script = RunWithAnnotatedErrors([&]() {
+			return Unmaybe(ScriptCompiler::Compile(context, GetStreamedSource(), GetSourceString(), GetScriptOrigin()))->GetUnboundScript();
+		});
+		script = RemoteHandle<UnboundScript>{unbound_script};
+		UpdateCachedData(false, unbound_script);
 		ResetSource();
 		heap_check.Epilogue();
 	}
 
+	void Phase2Abandon() final {
+		ResetSource();
+	}
+
 	auto Phase3() -> Local<Value> final {
 		// Wrap UnboundScript in JS Script{} class
 		Local<Object> value = ClassHandle::NewInstance<ScriptHandle>(std::move(script));
@@ -261,9 +452,11 @@ auto IsolateHandle::CompileScript(Local<String> code_handle, MaybeLocal<Object>
 struct CompileModuleRunner : public CodeCompilerHolder, public ThreePhaseTask {
 	shared_ptr<ModuleInfo> module_info;
 	RemoteHandle<Function> meta_callback;
+	std::string specifier;
 
 	CompileModuleRunner(const Local<String>& code_handle, const MaybeLocal<Object>& maybe_options) :
-		CodeCompilerHolder{code_handle, maybe_options, true} {
+		CodeCompilerHolder{code_handle, maybe_options, true},
+		specifier{ReadOption<std::string>(maybe_options, StringTable::Get().specifier, {})} {
 
 		auto maybe_meta_callback = ReadOption<MaybeLocal<Function>>(maybe_options, StringTable::Get().meta, {});
 		Local<Function> meta_callback;
@@ -274,22 +467,46 @@ struct CompileModuleRunner : public CodeCompilerHolder, public ThreePhaseTask {
 
 	void Phase2() final {
 		auto& isolate = IsolateEnvironment::GetCurrent();
+		ConsultCodeCache();
+		if (!HasCachedData() && DeferToBackground()) {
+			StartStreaming(ScriptType::kModule);
+			return;
+		}
 		Context::Scope context_scope(isolate.DefaultContext());
 		IsolateEnvironment::HeapCheck heap_check{isolate, true};
 		auto source = GetSource();
+		auto compile_options = GetCompileOptions();
 		auto module_handle = RunWithAnnotatedErrors(
-			[&]() { return Unmaybe(ScriptCompiler::CompileModule(isolate, source.get())); }
+			[&]() { return Unmaybe(ScriptCompiler::CompileModule(isolate, source.get(), compile_options)); }
 		);
 
-		if (DidSupplyCachedData()) {
-			SetCachedDataRejected(source->GetCachedData()->rejected);
-		}
-		if (ShouldProduceCachedData()) {
-			ScriptCompiler::CachedData* cached_data = ScriptCompiler::CreateCodeCache(module_handle->GetUnboundModuleScript());
-			assert(cached_data != nullptr);
-			SaveCachedData(cached_data);
-		}
+		UpdateCachedData(*source, module_handle->GetUnboundModuleScript());
+		SetModule(module_handle);
+		heap_check.Epilogue();
+	}
+
+	void Phase2Background() final {
+		RunStreaming();
+	}
+
+	void Phase2Finalize() final {
+		auto& isolate = IsolateEnvironment::GetCurrent();
+		auto context = isolate.DefaultContext();
+		Context::Scope context_scope(context);
+		IsolateEnvironment::HeapCheck heap_check{isolate, true};
+		auto module_handle = RunWithAnnotatedErrors([&]() {
+			return Unmaybe(ScriptCompiler::CompileModule(context, GetStreamedSource(), GetSourceString(), GetScriptOrigin()));
+		});
+		UpdateCachedData(false, module_handle->GetUnboundModuleScript());
+		SetModule(module_handle);
+		heap_check.Epilogue();
+	}
+
+	void Phase2Abandon() final {
+		ResetSource();
+	}
 
+	void SetModule(Local<Module> module_handle) {
 		ResetSource();
 		module_info = std::make_shared<ModuleInfo>(module_handle);
 		if (meta_callback) {
@@ -298,7 +515,9 @@ struct CompileModuleRunner : public CodeCompilerHolder, public ThreePhaseTask {
 			}
 			module_info->meta_callback = meta_callback;
 		}
-		heap_check.Epilogue();
+		if (!specifier.empty()) {
+			IsolateEnvironment::GetCurrent().module_registry[specifier] = module_info;
+		}
 	}
 
 	auto Phase3() -> Local<Value> final {
@@ -313,6 +532,300 @@ auto IsolateHandle::CompileModule(Local<String> code_handle, MaybeLocal<Object>
 	return ThreePhaseTask::Run<async, CompileModuleRunner>(*this->isolate, code_handle, maybe_options);
 }
 
+/**
+ * Compiles a whole module graph in one trip to the isolate. Each module is registered under its
+ * specifier so the graph can be instantiated without a resolve callback.
+ */
+struct CompileModulesRunner : public ThreePhaseTask {
+	struct Entry : public CodeCompilerHolder {
+		Entry(Local<String> code_handle, Local<Object> options) :
+			CodeCompilerHolder{code_handle, options, true},
+			specifier{ReadOption<std::string>(options, StringTable::Get().specifier, {})} {
+
+			auto maybe_meta_callback = ReadOption<MaybeLocal<Function>>(options, StringTable::Get().meta, {});
+			Local<Function> meta_callback;
+			if (maybe_meta_callback.ToLocal(&meta_callback)) {
+				this->meta_callback = RemoteHandle<Function>{meta_callback};
+			}
+		}
+
+		std::string specifier;
+		RemoteHandle<Function> meta_callback;
+		shared_ptr<ModuleInfo> module_info;
+	};
+	std::vector<std::unique_ptr<Entry>> entries;
+
+	explicit CompileModulesRunner(ArrayRange entry_handles) {
+		Local<Context> context = Isolate::GetCurrent()->GetCurrentContext();
+		std::unordered_set<std::string> specifiers;
+		for (auto value : entry_handles) {
+			auto entry_handle = HandleCast<Local<Object>>(value);
+			Local<Value> code = Unmaybe(entry_handle->Get(context, StringTable::Get().code));
+			if (!code->IsString()) {
+				throw RuntimeTypeError("`code` property is required");
+			}
+			auto& entry = *entries.emplace_back(std::make_unique<Entry>(code.As<String>(), entry_handle));
+			if (entry.specifier.empty()) {
+				throw RuntimeTypeError("`specifier` property is required");
+			}
+			if (!specifiers.insert(entry.specifier).second) {
+				throw RuntimeGenericError("Duplicate specifier '" + entry.specifier + "'");
+			}
+		}
+	}
+
+	void Phase2() final {
+		bool stream = false;
+		for (auto& entry : entries) {
+			entry->ConsultCodeCache();
+			stream = stream || !entry->HasCachedData();
+		}
+		if (stream && DeferToBackground()) {
+			for (auto& entry : entries) {
+				if (!entry->HasCachedData()) {
+					entry->StartStreaming(ScriptType::kModule);
+				}
+			}
+			return;
+		}
+		Compile();
+	}
+
+	void Phase2Background() final {
+		for (auto& entry : entries) {
+			if (entry->GetStreamedSource() != nullptr) {
+				entry->RunStreaming();
+			}
+		}
+	}
+
+	void Phase2Finalize() final {
+		Compile();
+	}
+
+	void Phase2Abandon() final {
+		for (auto& entry : entries) {
+			entry->ResetSource();
+		}
+	}
+
+	void Compile() {
+		auto& isolate = IsolateEnvironment::GetCurrent();
+		auto context = isolate.DefaultContext();
+		Context::Scope context_scope(context);
+		IsolateEnvironment::HeapCheck heap_check{isolate, true};
+		for (auto& entry : entries) {
+			Local<Module> module_handle;
+			if (entry->GetStreamedSource() == nullptr) {
+				auto source = entry->GetSource();
+				auto compile_options = entry->GetCompileOptions();
+				module_handle = RunWithAnnotatedErrors(
+					[&]() { return Unmaybe(ScriptCompiler::CompileModule(isolate, source.get(), compile_options)); }
+				);
+				entry->UpdateCachedData(*source, module_handle->GetUnboundModuleScript());
+			} else {
+				module_handle = RunWithAnnotatedErrors([&]() {
+					return Unmaybe(ScriptCompiler::CompileModule(context, entry->GetStreamedSource(), entry->GetSourceString(), entry->GetScriptOrigin()));
+				});
+				entry->UpdateCachedData(false, module_handle->GetUnboundModuleScript());
+			}
+			entry->ResetSource();
+			entry->module_info = std::make_shared<ModuleInfo>(module_handle);
+			if (entry->meta_callback) {
+				if (entry->meta_callback.GetSharedIsolateHolder() != IsolateEnvironment::GetCurrentHolder()) {
+					throw RuntimeGenericError("`meta` callback must belong to entered isolate");
+				}
+				entry->module_info->meta_callback = entry->meta_callback;
+			}
+		}
+		// Registration waits until every module compiled so a syntax error leaves the registry as it was
+		for (auto& entry : entries) {
+			isolate.module_registry[entry->specifier] = entry->module_info;
+		}
+		heap_check.Epilogue();
+	}
+
+	auto Phase3() -> Local<Value> final {
+		Isolate* isolate = Isolate::GetCurrent();
+		Local<Context> context = isolate->GetCurrentContext();
+		Local<Array> modules = Array::New(isolate, entries.size());
+		for (size_t ii = 0; ii < entries.size(); ++ii) {
+			Local<Object> value = ClassHandle::NewInstance<ModuleHandle>(std::move(entries[ii]->module_info));
+			entries[ii]->WriteCompileResults(value);
+			Unmaybe(modules->Set(context, ii, value));
+		}
+		return modules;
+	}
+};
+
+template <int async>
+auto IsolateHandle::CompileModules(ArrayRange entry_handles) -> Local<Value> {
+	return ThreePhaseTask::Run<async, CompileModulesRunner>(*this->isolate, entry_handles);
+}
+
+/**
+ * Drops a module from the isolate's registry. Instances which already linked against it are unaffected.
+ */
+struct UnregisterModuleRunner : public ThreePhaseTask {
+	explicit UnregisterModuleRunner(std::string specifier) : specifier{std::move(specifier)} {}
+
+	void Phase2() final {
+		removed = IsolateEnvironment::GetCurrent().module_registry.erase(specifier) != 0;
+	}
+
+	auto Phase3() -> Local<Value> final {
+		return Boolean::New(Isolate::GetCurrent(), removed);
+	}
+
+	std::string specifier;
+	bool removed = false;
+};
+
+template <int async>
+auto IsolateHandle::UnregisterModule(Local<String> specifier) -> Local<Value> {
+	return ThreePhaseTask::Run<async, UnregisterModuleRunner>(*isolate, HandleCast<std::string>(specifier));
+}
+
+/**
+ * Compiles WebAssembly by streaming it into v8 a chunk at a time. Chunks are read on the thread pool
+ * and handed to `WasmStreaming` back in the isolate, which is where v8 wants them. v8 compiles the
+ * module on its own threads in the meantime.
+ */
+struct CompileWasmRunner : public ThreePhaseTask {
+	static constexpr size_t kChunkSize = 1024 * 1024;
+
+	shared_ptr<BackingStore> buffer;
+	std::string path;
+	std::ifstream file;
+	std::string url;
+	std::vector<uint8_t> chunk;
+	const uint8_t* chunk_data = nullptr;
+	size_t chunk_length = 0;
+	size_t offset = 0;
+	bool read_failed = false;
+	shared_ptr<WasmStreaming> streaming;
+	RemoteHandle<Context> context;
+	RemoteHandle<Promise> promise;
+	std::optional<CompiledWasmModule> module;
+
+	CompileWasmRunner(Local<Value> source, MaybeLocal<Object> maybe_options) {
+		if (source->IsString()) {
+			path = HandleCast<std::string>(source);
+			file.open(path, std::ios::binary);
+			if (!file) {
+				throw RuntimeGenericError("Failed to open '" + path + "'");
+			}
+		} else {
+			auto* copy_handle = source->IsObject() ? ClassHandle::Unwrap<ExternalCopyHandle>(source.As<Object>()) : nullptr;
+			auto* copy_ptr = copy_handle == nullptr ? nullptr : dynamic_cast<ExternalCopyAnyBuffer*>(copy_handle->GetValue().get());
+			if (copy_ptr == nullptr) {
+				throw RuntimeTypeError("`source` must be a filename or an ExternalCopy to ArrayBuffer");
+			}
+			buffer = copy_ptr->Acquire();
+		}
+		url = ReadOption<std::string>(maybe_options, StringTable::Get().filename, path);
+	}
+
+	static void StreamingCallback(const FunctionCallbackInfo<Value>& info) {
+		auto streaming = WasmStreaming::Unpack(info.GetIsolate(), info.Data());
+		if (info[0]->IsExternal()) {
+			static_cast<CompileWasmRunner*>(info[0].As<External>()->Value())->streaming = std::move(streaming);
+		} else {
+			streaming->Abort(Exception::TypeError(v8_string("WebAssembly.compileStreaming() is not supported")));
+		}
+	}
+
+	void Phase2() final {
+		auto& env = IsolateEnvironment::GetCurrent();
+		Isolate* isolate = env.GetIsolate();
+		// `compileStreaming()` only exists on contexts created while a streaming callback is set, so a
+		// private context is used and the callback is removed again once it has run. Code running in
+		// the isolate never sees it.
+		isolate->SetWasmStreamingCallback(StreamingCallback);
+		auto context = env.NewContext();
+		this->context = RemoteHandle<Context>{context};
+		Context::Scope context_scope{context};
+		auto web_assembly = Unmaybe(context->Global()->Get(context, StringTable::Get().WebAssembly)).As<Object>();
+		auto compile_streaming = Unmaybe(web_assembly->Get(context, StringTable::Get().compileStreaming)).As<Function>();
+		Local<Value> argv[] = { External::New(isolate, this) };
+		auto promise_handle = Unmaybe(compile_streaming->Call(context, Undefined(isolate), 1, argv)).As<Promise>();
+		// Failures are picked up in `Phase2Finalize()`, not reported as unhandled rejections
+		promise_handle->MarkAsHandled();
+		promise = RemoteHandle<Promise>{promise_handle};
+		isolate->PerformMicrotaskCheckpoint();
+		isolate->SetWasmStreamingCallback(nullptr);
+		if (!streaming) {
+			throw RuntimeGenericError("Failed to start WebAssembly compilation");
+		}
+		if (!url.empty()) {
+			streaming->SetUrl(url.data(), url.size());
+		}
+		DeferToBackground();
+	}
+
+	static void OnSettled(const FunctionCallbackInfo<Value>& info) {
+		ThreePhaseTask::Resume(*static_cast<CompileWasmRunner*>(info.Data().As<External>()->Value()));
+	}
+
+	void Phase2Background() final {
+		if (buffer) {
+			chunk_data = static_cast<const uint8_t*>(buffer->Data()) + offset;
+			chunk_length = std::min(kChunkSize, buffer->ByteLength() - offset);
+			offset += chunk_length;
+		} else {
+			chunk.resize(kChunkSize);
+			file.read(reinterpret_cast<char*>(chunk.data()), kChunkSize);
+			read_failed = file.bad();
+			chunk_data = chunk.data();
+			chunk_length = static_cast<size_t>(file.gcount());
+		}
+	}
+
+	void Phase2Finalize() final {
+		auto context = this->context.Deref();
+		Context::Scope context_scope{context};
+		auto promise = this->promise.Deref();
+		if (promise->State() == Promise::kPending) {
+			if (read_failed) {
+				streaming->Abort({});
+				streaming.reset();
+				throw RuntimeGenericError("Failed to read '" + path + "'");
+			}
+			if (chunk_length == 0) {
+				// v8 settles the promise from a foreground task once it's done compiling. The reaction
+				// brings this task back to pick up the result.
+				streaming->Finish();
+				auto on_settled = Unmaybe(Function::New(context, OnSettled, External::New(Isolate::GetCurrent(), this)));
+				Unmaybe(promise->Then(context, on_settled, on_settled));
+				DeferUntilResumed();
+			} else {
+				streaming->OnBytesReceived(chunk_data, chunk_length);
+				DeferToBackground();
+			}
+			return;
+		}
+		streaming.reset();
+		if (promise->State() == Promise::kFulfilled) {
+			module.emplace(promise->Result().As<WasmModuleObject>()->GetCompiledModule());
+		} else {
+			Isolate::GetCurrent()->ThrowException(promise->Result());
+			throw RuntimeError();
+		}
+	}
+
+	void Phase2Abandon() final {
+		streaming.reset();
+	}
+
+	auto Phase3() -> Local<Value> final {
+		return ClassHandle::NewInstance<ExternalCopyHandle>(std::make_shared<ExternalCopyWasmModule>(std::move(*module)));
+	}
+};
+
+auto IsolateHandle::CompileWasm(Local<Value> source, MaybeLocal<Object> maybe_options) -> Local<Value> {
+	return ThreePhaseTask::Run<1, CompileWasmRunner>(*this->isolate, source, maybe_options);
+}
+
 /**
  * Create a new channel for debugging on the inspector
  */
@@ -334,71 +847,195 @@ auto IsolateHandle::CreateInspectorSession() -> Local<Value> {
  * Dispose an isolate
  */
 auto IsolateHandle::Dispose() -> Local<Value> {
-	if (!isolate->Dispose()) {
+	struct ResolveTask : Runnable {
+		explicit ResolveTask(RemoteTuple<Promise::Resolver, Context> resolver) : resolver{std::move(resolver)} {}
+
+		void Run() final {
+			auto context = this->resolver.Deref<1>();
+			Context::Scope context_scope{context};
+			Unmaybe(this->resolver.Deref<0>()->Resolve(context, Undefined(Isolate::GetCurrent())));
+			Isolate::GetCurrent()->PerformMicrotaskCheckpoint();
+		}
+
+		RemoteTuple<Promise::Resolver, Context> resolver;
+	};
+
+	auto* isolate = Isolate::GetCurrent();
+	auto context = isolate->GetCurrentContext();
+	auto resolver = Unmaybe(Promise::Resolver::New(context));
+	// Doesn't use `GetIsolate()` since that would wake a hibernating isolate just to dispose it
+	auto dispose_wait = this->isolate->GetDisposeWait();
+	if (!dispose_wait) {
+		throw RuntimeGenericError("Isolate is already disposed");
+	}
+	if (!this->isolate->Dispose()) {
 		throw RuntimeGenericError("Isolate is already disposed");
 	}
-	return Undefined(Isolate::GetCurrent());
+	// The heap is torn down on a background thread. Whichever thread finishes the job is holding a
+	// ref to the default isolate, so it's safe to wake this one from there.
+	auto remote = std::make_shared<RemoteTuple<Promise::Resolver, Context>>(resolver, context);
+	auto holder = IsolateEnvironment::GetCurrentHolder();
+	dispose_wait->OnDispose([=]() {
+		holder->ScheduleTask(std::make_unique<ResolveTask>(std::move(*remote)), false, true);
+	});
+	return resolver->GetPromise();
+}
+
+/**
+ * Throw away the heap of an idle isolate, it's rebuilt from its snapshot when next used
+ */
+struct HibernateRunner : public ThreePhaseTask {
+	explicit HibernateRunner(shared_ptr<IsolateHolder> holder) : holder{std::move(holder)} {}
+
+	void Phase2() final {
+		IsolateEnvironment::Hibernate(*holder, [](IsolateEnvironment& env) {
+			env->SetHostImportModuleDynamicallyCallback(ModuleHandle::ImportModuleDynamically);
+			env->SetHostInitializeImportMetaObjectCallback(ModuleHandle::InitializeImportMeta);
+			env->SetWasmModuleCallback(WasmCache::ModuleCallback);
+		});
+	}
+
+	auto Phase3() -> Local<Value> final {
+		return Undefined(Isolate::GetCurrent());
+	}
+
+	shared_ptr<IsolateHolder> holder;
+};
+template <int async>
+auto IsolateHandle::Hibernate() -> Local<Value> {
+	if (IsolateEnvironment::GetCurrentHolder() == isolate) {
+		throw RuntimeGenericError("An isolate can't hibernate from within itself");
+	} else if (isolate->IsHibernating()) {
+		throw RuntimeGenericError("Isolate is already hibernating");
+	}
+	return ThreePhaseTask::Run<async, HibernateRunner>(*isolate, isolate);
+}
+
+/**
+ * Statistics for read-only accessors. These never rebuild a hibernating isolate, instead they report
+ * what it published before going to sleep.
+ */
+static auto ReadStatsSnapshot(IsolateHolder& holder) -> IsolateEnvironment::StatsSnapshot {
+	auto env = holder.GetIsolateIfAwake();
+	if (!env) {
+		env = holder.GetHibernation();
+		if (!env) {
+			// Revived or disposed since the first check
+			env = holder.GetIsolateIfAwake();
+			if (!env) {
+				throw RuntimeGenericError("Isolate is disposed");
+			}
+		}
+	}
+	return env->GetStatsSnapshot();
+}
+
+static auto HeapStatisticsObject(const IsolateEnvironment::StatsSnapshot& heap) -> Local<Object> {
+	Isolate* isolate = Isolate::GetCurrent();
+	Local<Context> context = isolate->GetCurrentContext();
+	Local<Object> ret = Object::New(isolate);
+	auto& strings = StringTable::Get();
+	Unmaybe(ret->Set(context, strings.total_heap_size, Number::New(isolate, heap.total_heap_size)));
+	Unmaybe(ret->Set(context, strings.total_heap_size_executable, Number::New(isolate, heap.total_heap_size_executable)));
+	Unmaybe(ret->Set(context, strings.total_physical_size, Number::New(isolate, heap.total_physical_size)));
+	Unmaybe(ret->Set(context, strings.total_available_size, Number::New(isolate, heap.total_available_size)));
+	Unmaybe(ret->Set(context, strings.used_heap_size, Number::New(isolate, heap.used_heap_size)));
+	Unmaybe(ret->Set(context, strings.heap_size_limit, Number::New(isolate, heap.heap_size_limit)));
+	Unmaybe(ret->Set(context, strings.malloced_memory, Number::New(isolate, heap.malloced_memory)));
+	Unmaybe(ret->Set(context, strings.peak_malloced_memory, Number::New(isolate, heap.peak_malloced_memory)));
+	Unmaybe(ret->Set(context, strings.externally_allocated_size, Number::New(isolate, heap.externally_allocated_size)));
+	Unmaybe(ret->Set(context, strings.number_of_native_contexts, Number::New(isolate, heap.number_of_native_contexts)));
+	Unmaybe(ret->Set(context, strings.number_of_detached_contexts, Number::New(isolate, heap.number_of_detached_contexts)));
+	return ret;
 }
 
 /**
  * Get heap statistics from v8
  */
 struct HeapStatRunner : public ThreePhaseTask {
-	HeapStatistics heap;
-	size_t externally_allocated_size = 0;
-	size_t adjustment = 0;
+	IsolateEnvironment::StatsSnapshot stats;
+	bool does_zap_garbage = false;
 
 	// Dummy constructor to workaround gcc bug
 	explicit HeapStatRunner(int /*unused*/) {}
 
 	void Phase2() final {
 		IsolateEnvironment& isolate = IsolateEnvironment::GetCurrent();
+		HeapStatistics heap;
 		isolate->GetHeapStatistics(&heap);
-		adjustment = heap.heap_size_limit() - isolate.GetInitialHeapSizeLimit();
-		externally_allocated_size = isolate.GetExtraAllocatedMemory();
+		size_t adjustment = heap.heap_size_limit() - isolate.GetInitialHeapSizeLimit();
+		stats.total_heap_size = heap.total_heap_size();
+		stats.total_heap_size_executable = heap.total_heap_size_executable();
+		stats.total_physical_size = heap.total_physical_size();
+		stats.total_available_size = heap.total_available_size() - std::min(adjustment, heap.total_available_size());
+		stats.used_heap_size = heap.used_heap_size();
+		stats.heap_size_limit = heap.heap_size_limit() - adjustment;
+		stats.malloced_memory = heap.malloced_memory();
+		stats.peak_malloced_memory = heap.peak_malloced_memory();
+		stats.externally_allocated_size = isolate.GetExtraAllocatedMemory();
+		stats.number_of_native_contexts = heap.number_of_native_contexts();
+		stats.number_of_detached_contexts = heap.number_of_detached_contexts();
+		does_zap_garbage = heap.does_zap_garbage() != 0;
 	}
 
 	auto Phase3() -> Local<Value> final {
 		Isolate* isolate = Isolate::GetCurrent();
-		Local<Context> context = isolate->GetCurrentContext();
-		Local<Object> ret = Object::New(isolate);
-		auto& strings = StringTable::Get();
-		Unmaybe(ret->Set(context, strings.total_heap_size, Number::New(isolate, heap.total_heap_size())));
-		Unmaybe(ret->Set(context, strings.total_heap_size_executable, Number::New(isolate, heap.total_heap_size_executable())));
-		Unmaybe(ret->Set(context, strings.total_physical_size, Number::New(isolate, heap.total_physical_size())));
-		Unmaybe(ret->Set(context, strings.total_available_size, Number::New(isolate, static_cast<double>(heap.total_available_size()) - adjustment)));
-		Unmaybe(ret->Set(context, strings.used_heap_size, Number::New(isolate, heap.used_heap_size())));
-		Unmaybe(ret->Set(context, strings.heap_size_limit, Number::New(isolate, static_cast<double>(heap.heap_size_limit()) - adjustment)));
-		Unmaybe(ret->Set(context, strings.malloced_memory, Number::New(isolate, heap.malloced_memory())));
-		Unmaybe(ret->Set(context, strings.peak_malloced_memory, Number::New(isolate, heap.peak_malloced_memory())));
-		Unmaybe(ret->Set(context, strings.does_zap_garbage, Number::New(isolate, heap.does_zap_garbage())));
-		Unmaybe(ret->Set(context, strings.externally_allocated_size, Number::New(isolate, externally_allocated_size)));
+		auto ret = HeapStatisticsObject(stats);
+		Unmaybe(ret->Set(isolate->GetCurrentContext(), StringTable::Get().does_zap_garbage, Number::New(isolate, does_zap_garbage)));
 		return ret;
 	}
 };
 template <int async>
 auto IsolateHandle::GetHeapStatistics() -> Local<Value> {
+	if (isolate->IsHibernating() && !isolate->GetIsolateIfAwake()) {
+		// There's no heap to measure, and rebuilding one just to measure it would be silly
+		IsolateEnvironment::StatsSnapshot stats;
+		stats.heap_size_limit = ReadStatsSnapshot(*isolate).heap_size_limit;
+		stats.total_available_size = stats.heap_size_limit;
+		Isolate* isolate = Isolate::GetCurrent();
+		auto context = isolate->GetCurrentContext();
+		auto result = HeapStatisticsObject(stats);
+		Unmaybe(result->Set(context, StringTable::Get().does_zap_garbage, Number::New(isolate, 0)));
+		if (async) {
+			auto resolver = Unmaybe(Promise::Resolver::New(context));
+			Unmaybe(resolver->Resolve(context, result));
+			return resolver->GetPromise();
+		}
+		return result;
+	}
 	return ThreePhaseTask::Run<async, HeapStatRunner>(*isolate, 0);
 }
 
 /**
- * Timers
+ * Reads statistics last published by the isolate, without waiting for it
+ */
+auto IsolateHandle::GetStatsSnapshot() -> Local<Value> {
+	auto stats = ReadStatsSnapshot(*this->isolate);
+	Isolate* isolate = Isolate::GetCurrent();
+	Local<Context> context = isolate->GetCurrentContext();
+	auto ret = HeapStatisticsObject(stats);
+	auto& strings = StringTable::Get();
+	Unmaybe(ret->Set(context, strings.cpuTime, HandleCast<Local<BigInt>>(static_cast<uint64_t>(stats.cpu_time.count()))));
+	Unmaybe(ret->Set(context, strings.wallTime, HandleCast<Local<BigInt>>(static_cast<uint64_t>(stats.wall_time.count()))));
+	Unmaybe(ret->Set(context, strings.queueDepth, Number::New(isolate, stats.queue_depth)));
+	Unmaybe(ret->Set(context, strings.evalCacheHits, Number::New(isolate, stats.eval_cache_hits)));
+	Unmaybe(ret->Set(context, strings.evalCacheMisses, Number::New(isolate, stats.eval_cache_misses)));
+	Unmaybe(ret->Set(context, strings.timestamp, Number::New(isolate, stats.timestamp)));
+	return ret;
+}
+
+/**
+ * Timers. A hibernating isolate reports the times it published before hibernating.
  */
 auto IsolateHandle::GetCpuTime() -> Local<Value> {
-	auto env = this->isolate->GetIsolate();
-	if (!env) {
-		throw RuntimeGenericError("Isolate is disposed");
-	}
-	uint64_t time = env->GetCpuTime().count();
+	auto env = this->isolate->GetIsolateIfAwake();
+	uint64_t time = (env ? env->GetCpuTime() : ReadStatsSnapshot(*isolate).cpu_time).count();
 	return HandleCast<Local<BigInt>>(time);
 }
 
 auto IsolateHandle::GetWallTime() -> Local<Value> {
-	auto env = this->isolate->GetIsolate();
-	if (!env) {
-		throw RuntimeGenericError("Isolate is disposed");
-	}
-	uint64_t time = env->GetWallTime().count();
+	auto env = this->isolate->GetIsolateIfAwake();
+	uint64_t time = (env ? env->GetWallTime() : ReadStatsSnapshot(*isolate).wall_time).count();
 	return HandleCast<Local<BigInt>>(time);
 }
 
@@ -441,8 +1078,11 @@ auto IsolateHandle::StopCpuProfiler(v8::Local<v8::String> title) -> Local<Value>
  * Reference count
  */
 auto IsolateHandle::GetReferenceCount() -> Local<Value> {
-	auto env = this->isolate->GetIsolate();
+	auto env = this->isolate->GetIsolateIfAwake();
 	if (!env) {
+		if (isolate->IsHibernating()) {
+			return Number::New(Isolate::GetCurrent(), 0);
+		}
 		throw RuntimeGenericError("Isolate is disposed");
 	}
 	return Number::New(Isolate::GetCurrent(), env->GetRemotesCount());
@@ -452,7 +1092,11 @@ auto IsolateHandle::GetReferenceCount() -> Local<Value> {
  * Simple disposal checker
  */
 auto IsolateHandle::IsDisposedGetter() -> Local<Value> {
-	return Boolean::New(Isolate::GetCurrent(), !isolate->GetIsolate());
+	return Boolean::New(Isolate::GetCurrent(), isolate->IsDisposed());
+}
+
+auto IsolateHandle::IsHibernatingGetter() -> Local<Value> {
+	return Boolean::New(Isolate::GetCurrent(), isolate->IsHibernating());
 }
 
 /**
@@ -462,162 +1106,451 @@ static auto SerializeInternalFieldsCallback(Local<Object> /*holder*/, int /*inde
 	return {nullptr, 0};
 }
 
-auto IsolateHandle::CreateSnapshot(ArrayRange script_handles, MaybeLocal<String> warmup_handle) -> Local<Value> {
+namespace {
 
-	// Simple platform delegate and task queue
-	using TaskDeque = lockable_t<std::deque<std::unique_ptr<v8::Task>>>;
-	class SnapshotPlatformDelegate :
-			public node::IsolatePlatformDelegate, public TaskRunner,
-			public std::enable_shared_from_this<SnapshotPlatformDelegate> {
+// Simple platform delegate and task queue
+using TaskDeque = lockable_t<std::deque<std::unique_ptr<v8::Task>>>;
+class SnapshotPlatformDelegate :
+		public node::IsolatePlatformDelegate, public TaskRunner,
+		public std::enable_shared_from_this<SnapshotPlatformDelegate> {
 
-		public:
-			explicit SnapshotPlatformDelegate(TaskDeque& tasks) : tasks{tasks} {}
+	public:
+		explicit SnapshotPlatformDelegate(TaskDeque& tasks) : tasks{tasks} {}
 
-			// v8 will continually post delayed tasks so we cut it off when work is done
-			void DoneWithWork() {
-				done = true;
-			}
+		// v8 will continually post delayed tasks so we cut it off when work is done
+		void DoneWithWork() {
+			done = true;
+		}
 
-			// Methods for IsolatePlatformDelegate
-			auto GetForegroundTaskRunner() -> std::shared_ptr<v8::TaskRunner> final {
-			 return shared_from_this();
-			}
-			auto IdleTasksEnabled() -> bool final {
-				return false;
-			}
+		// Methods for IsolatePlatformDelegate
+		auto GetForegroundTaskRunner() -> std::shared_ptr<v8::TaskRunner> final {
+		 return shared_from_this();
+		}
+		auto IdleTasksEnabled() -> bool final {
+			return false;
+		}
 
-			// Methods for v8::TaskRunner
-			void PostTaskImpl(std::unique_ptr<v8::Task> task, const v8::SourceLocation& /*location*/) final {
-				tasks.write()->push_back(std::move(task));
-			}
-			void PostDelayedTaskImpl(std::unique_ptr<v8::Task> task, double /*delay_in_seconds*/, const v8::SourceLocation& location) final {
-				if (!done) {
+		// Methods for v8::TaskRunner
+		void PostTaskImpl(std::unique_ptr<v8::Task> task, const v8::SourceLocation& /*location*/) final {
+			tasks.write()->push_back(std::move(task));
+		}
+		void PostDelayedTaskImpl(std::unique_ptr<v8::Task> task, double /*delay_in_seconds*/, const v8::SourceLocation& location) final {
+			if (!done) {
 #if V8_AT_LEAST(13, 3, 241)
-					PostTask(std::move(task), location);
+				PostTask(std::move(task), location);
 #else
-					PostTask(std::move(task));
+				PostTask(std::move(task));
 #endif
-				}
 			}
-			void PostNonNestableTaskImpl(std::unique_ptr<v8::Task> task, const v8::SourceLocation& location) final {
+		}
+		void PostNonNestableTaskImpl(std::unique_ptr<v8::Task> task, const v8::SourceLocation& location) final {
 #if V8_AT_LEAST(13, 3, 241)
-					PostTask(std::move(task), location);
+				PostTask(std::move(task), location);
 #else
-					PostTask(std::move(task));
+				PostTask(std::move(task));
 #endif
-			}
+		}
 
-		private:
-			lockable_t<std::deque<std::unique_ptr<v8::Task>>>& tasks;
-			bool done = false;
+	private:
+		lockable_t<std::deque<std::unique_ptr<v8::Task>>>& tasks;
+		bool done = false;
+};
+
+// Snapshots made with `cache: true`, most recently used first. A pending entry is shared by everyone
+// asking for the same snapshot so it's only built once. Snapshots are large so only a few are kept.
+using SnapshotFuture = std::shared_future<std::shared_ptr<BackingStore>>;
+struct SnapshotCache {
+	static constexpr size_t kMaxEntries = 8;
+	struct Entry {
+		std::string key;
+		SnapshotFuture future;
+		// Identifies the job building this entry, so it only removes its own entry if the build fails
+		const void* owner;
 	};
+	std::list<Entry> entries;
+	std::unordered_map<std::string, std::list<Entry>::iterator> index;
 
-	TaskDeque tasks;
-	auto delegate = std::make_shared<SnapshotPlatformDelegate>(tasks);
+	auto Find(const std::string& key) -> std::optional<SnapshotFuture> {
+		auto it = index.find(key);
+		if (it == index.end()) {
+			return std::nullopt;
+		}
+		entries.splice(entries.begin(), entries, it->second);
+		return it->second->future;
+	}
 
-	// Copy embed scripts and warmup script from outer isolate
-	std::vector<std::pair<ExternalCopyString, ScriptOriginHolder>> scripts;
-	Isolate* isolate = Isolate::GetCurrent();
-	Local<Context> context = isolate->GetCurrentContext();
-	scripts.reserve(std::distance(script_handles.begin(), script_handles.end()));
-	for (auto value : script_handles) {
-		auto script_handle = HandleCast<Local<Object>>(value);
-		Local<Value> script = Unmaybe(script_handle.As<Object>()->Get(context, StringTable::Get().code));
-		if (!script->IsString()) {
-			throw RuntimeTypeError("`code` property is required");
-		}
-		scripts.emplace_back(ExternalCopyString{script.As<String>()}, ScriptOriginHolder{script_handle});
-	}
-	ExternalCopyString warmup_script;
-	if (!warmup_handle.IsEmpty()) {
-		warmup_script = ExternalCopyString{warmup_handle.ToLocalChecked().As<String>()};
-	}
-
-	// Create the snapshot
-	StartupData snapshot {};
-	unique_ptr<const char[]> snapshot_data_ptr;
-	shared_ptr<ExternalCopy> error;
-	{
-		Isolate* isolate;
-		isolate = Isolate::Allocate();
-		PlatformDelegate::RegisterIsolate(isolate, delegate.get());
-		SnapshotCreator snapshot_creator{isolate};
-		{
-			Locker locker(isolate);
-			Isolate::Scope isolate_scope(isolate);
-			HandleScope handle_scope(isolate);
-			Local<Context> context = Context::New(isolate);
-			snapshot_creator.SetDefaultContext(context, {&SerializeInternalFieldsCallback, nullptr});
-			FunctorRunners::RunCatchExternal(context, [&]() {
-				HandleScope handle_scope(isolate);
-				Local<Context> context_dirty = Context::New(isolate);
-				for (auto& script : scripts) {
-					Local<String> code = script.first.CopyInto().As<String>();
-					ScriptOrigin script_origin = ScriptOrigin{script.second};
-					ScriptCompiler::Source source{code, script_origin};
-					Local<UnboundScript> unbound_script;
-					{
-						Context::Scope context_scope{context};
-						Local<Script> compiled_script = RunWithAnnotatedErrors(
-							[&context, &source]() { return Unmaybe(ScriptCompiler::Compile(context, &source, ScriptCompiler::kNoCompileOptions)); }
-						);
-						Unmaybe(compiled_script->Run(context));
-						unbound_script = compiled_script->GetUnboundScript();
-					}
-					if (warmup_script) {
-						Context::Scope context_scope{context_dirty};
-						Unmaybe(unbound_script->BindToCurrentContext()->Run(context_dirty));
-					}
+	void Insert(const std::string& key, SnapshotFuture future, const void* owner) {
+		entries.push_front({ key, std::move(future), owner });
+		index.emplace(key, entries.begin());
+		while (entries.size() > kMaxEntries) {
+			// Anyone already waiting on an evicted entry holds their own reference to the future
+			index.erase(entries.back().key);
+			entries.pop_back();
+		}
+	}
+
+	void Erase(const std::string& key, const void* owner) {
+		auto it = index.find(key);
+		if (it != index.end() && it->second->owner == owner) {
+			entries.erase(it->second);
+			index.erase(it);
+		}
+	}
+};
+lockable_t<SnapshotCache> snapshot_cache;
+
+// Threads used by `createSnapshotAsync`
+thread_pool_t snapshot_threads{2};
+thread_pool_t::affinity_t snapshot_affinity;
+
+/**
+ * Everything needed to build a snapshot, copied out of the calling isolate so that the snapshot can
+ * be built on any thread. Sources are kept as plain UTF-16 instead of `ExternalCopyString` because
+ * external strings need an `IsolateEnvironment`, which the snapshot isolate doesn't have.
+ */
+class SnapshotJob {
+	public:
+		SnapshotJob(ArrayRange script_handles, MaybeLocal<String> warmup_handle, MaybeLocal<Object> maybe_options) :
+				scripts{ReadScripts(script_handles)},
+				cache{ReadOption<bool>(maybe_options, StringTable::Get().cache, false)},
+				cache_directory{ReadOption<std::string>(maybe_options, StringTable::Get().cacheDirectory, {})} {
+			for (auto context_scripts : ReadOption<ArrayRange>(maybe_options, StringTable::Get().contexts, {})) {
+				contexts.push_back(ReadScripts(HandleCast<ArrayRange>(context_scripts)));
+			}
+			Local<String> warmup;
+			if (warmup_handle.ToLocal(&warmup)) {
+				warmup_script = Copy(warmup);
+				has_warmup_script = true;
+			}
+		}
+
+		// Returns the snapshot, or nullptr with `error` set
+		auto Run() -> std::shared_ptr<BackingStore> {
+			if (!cache) {
+				return LoadOrBuild();
+			}
+			auto key = Key();
+			std::promise<std::shared_ptr<BackingStore>> promise;
+			auto [ future, owner ] = [&]() -> std::pair<SnapshotFuture, bool> {
+				auto lock = snapshot_cache.write();
+				if (auto found = lock->Find(key)) {
+					return { *found, false };
 				}
-				if (warmup_script) {
-					Context::Scope context_scope{context_dirty};
-					MaybeLocal<Object> tmp;
-					ScriptOriginHolder script_origin{tmp};
-					ScriptCompiler::Source source{warmup_script.CopyInto().As<String>(), ScriptOrigin{script_origin}};
-					RunWithAnnotatedErrors([&context_dirty, &source]() {
-						Unmaybe(Unmaybe(ScriptCompiler::Compile(context_dirty, &source, ScriptCompiler::kNoCompileOptions))->Run(context_dirty));
-					});
+				auto future = promise.get_future().share();
+				lock->Insert(key, future, this);
+				return { future, true };
+			}();
+			if (!owner) {
+				// If the first attempt failed this one will fail too, but with its own error
+				auto snapshot = future.get();
+				return snapshot ? CopySnapshot(*snapshot) : LoadOrBuild();
+			}
+			auto snapshot = LoadOrBuild();
+			if (!snapshot) {
+				snapshot_cache.write()->Erase(key, this);
+				promise.set_value(nullptr);
+				return nullptr;
+			}
+			promise.set_value(snapshot);
+			return CopySnapshot(*snapshot);
+		}
+
+		std::shared_ptr<ExternalCopy> error;
+
+	private:
+		using Scripts = std::vector<std::pair<std::u16string, ScriptOriginHolder>>;
+
+		// The caller may transfer the snapshot into an isolate and write to it, so callers get their own
+		// copy of a cached snapshot
+		static auto CopySnapshot(const BackingStore& snapshot) -> std::shared_ptr<BackingStore> {
+			auto length = snapshot.ByteLength();
+			void* data = std::malloc(length);
+			std::memcpy(data, snapshot.Data(), length);
+			return ArrayBuffer::NewBackingStore(
+				data, length,
+				[](void* data, size_t /*length*/, void* /*param*/) { std::free(data); },
+				nullptr);
+		}
+
+		static auto ReadScripts(ArrayRange script_handles) -> Scripts {
+			Scripts scripts;
+			Local<Context> context = Isolate::GetCurrent()->GetCurrentContext();
+			for (auto value : script_handles) {
+				auto script_handle = HandleCast<Local<Object>>(value);
+				Local<Value> script = Unmaybe(script_handle.As<Object>()->Get(context, StringTable::Get().code));
+				if (!script->IsString()) {
+					throw RuntimeTypeError("`code` property is required");
 				}
-			}, [ &error ](unique_ptr<ExternalCopy> error_inner) {
-				error = std::move(error_inner);
-			});
-			isolate->ContextDisposedNotification(false);
-
-			// Run all queued tasks
-			delegate->DoneWithWork();
-			while (true) {
-				auto task = [&]() -> std::unique_ptr<v8::Task> {
-					auto lock = tasks.write();
-					if (lock->empty()) {
-						return nullptr;
+				scripts.emplace_back(Copy(script.As<String>()), ScriptOriginHolder{script_handle});
+			}
+			return scripts;
+		}
+
+		// Compiles and runs each script in `context`, returning the scripts so they can be warmed up
+		static auto RunScripts(Local<Context> context, const Scripts& scripts) -> std::vector<Local<UnboundScript>> {
+			std::vector<Local<UnboundScript>> unbound_scripts;
+			Context::Scope context_scope{context};
+			for (const auto& script : scripts) {
+				ScriptCompiler::Source source{NewString(script.first), ScriptOrigin{script.second}};
+				Local<Script> compiled_script = RunWithAnnotatedErrors(
+					[&context, &source]() { return Unmaybe(ScriptCompiler::Compile(context, &source, ScriptCompiler::kNoCompileOptions)); }
+				);
+				Unmaybe(compiled_script->Run(context));
+				unbound_scripts.push_back(compiled_script->GetUnboundScript());
+			}
+			return unbound_scripts;
+		}
+
+		static void HashScripts(fnv1a_t& hash, const Scripts& scripts) {
+			size_t count = scripts.size();
+			hash.update(&count, sizeof(count));
+			for (const auto& script : scripts) {
+				hash.update(script.first.data(), script.first.size() * sizeof(char16_t));
+				script.second.Hash(hash);
+			}
+		}
+
+		static auto Copy(Local<String> string) -> std::u16string {
+			std::u16string copy(string->Length(), u'\0');
+#if V8_AT_LEAST(13, 3, 16)
+			string->WriteV2(Isolate::GetCurrent(), 0, copy.size(), reinterpret_cast<uint16_t*>(copy.data()), String::WriteFlags::kNone);
+#else
+			string->Write(Isolate::GetCurrent(), reinterpret_cast<uint16_t*>(copy.data()), 0, -1, String::WriteOptions::NO_NULL_TERMINATION);
+#endif
+			return copy;
+		}
+
+		static auto NewString(const std::u16string& string) -> Local<String> {
+			return Unmaybe(String::NewFromTwoByte(
+				Isolate::GetCurrent(), reinterpret_cast<const uint16_t*>(string.data()), NewStringType::kNormal, string.size()));
+		}
+
+		// Snapshots are only valid for the exact v8 which made them
+		auto Key() const -> std::string {
+			fnv1a_t hash;
+			hash.update(V8::GetVersion());
+			HashScripts(hash, scripts);
+			for (const auto& context_scripts : contexts) {
+				HashScripts(hash, context_scripts);
+			}
+			hash.update(&has_warmup_script, sizeof(has_warmup_script));
+			hash.update(warmup_script.data(), warmup_script.size() * sizeof(char16_t));
+			return hash.hex();
+		}
+
+		auto LoadOrBuild() -> std::shared_ptr<BackingStore> {
+			if (cache_directory.empty()) {
+				return Build();
+			}
+			auto path = cache_directory + "/" + Key() + ".snapshot";
+			if (auto snapshot = Load(path)) {
+				return snapshot;
+			}
+			auto snapshot = Build();
+			if (snapshot) {
+				Save(path, *snapshot);
+			}
+			return snapshot;
+		}
+
+		// Files end with a checksum of the snapshot so a truncated or corrupt file is never handed to v8,
+		// which doesn't check for itself. Anything which doesn't pass is removed and rebuilt.
+		static auto Load(const std::string& path) -> std::shared_ptr<BackingStore> {
+			std::ifstream file{path, std::ios::binary | std::ios::ate};
+			if (!file) {
+				return nullptr;
+			}
+			auto size = static_cast<size_t>(file.tellg());
+			if (size <= sizeof(uint64_t)) {
+				std::remove(path.c_str());
+				return nullptr;
+			}
+			size -= sizeof(uint64_t);
+			std::shared_ptr<BackingStore> snapshot = ArrayBuffer::NewBackingStore(
+				std::malloc(size), size,
+				[](void* data, size_t /*length*/, void* /*param*/) { std::free(data); },
+				nullptr);
+			uint64_t checksum = 0;
+			file.seekg(0);
+			if (
+				!file.read(static_cast<char*>(snapshot->Data()), size) ||
+				!file.read(reinterpret_cast<char*>(&checksum), sizeof(checksum)) ||
+				fnv1a_t{}.update(snapshot->Data(), size).digest() != checksum ||
+				!StartupData{static_cast<const char*>(snapshot->Data()), static_cast<int>(size)}.IsValid()
+			) {
+				std::remove(path.c_str());
+				return nullptr;
+			}
+			return snapshot;
+		}
+
+		// Failure just means the next process builds it again
+		static void Save(const std::string& path, BackingStore& snapshot) {
+			auto checksum = fnv1a_t{}.update(snapshot.Data(), snapshot.ByteLength()).digest();
+			std::string contents(static_cast<const char*>(snapshot.Data()), snapshot.ByteLength());
+			contents.append(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+			write_file_atomic(path, contents.data(), contents.size());
+		}
+
+		auto Build() -> std::shared_ptr<BackingStore> {
+			TaskDeque tasks;
+			auto delegate = std::make_shared<SnapshotPlatformDelegate>(tasks);
+			StartupData snapshot {};
+			Isolate* isolate;
+			isolate = Isolate::Allocate();
+			PlatformDelegate::RegisterIsolate(isolate, delegate.get());
+			{
+				SnapshotCreator snapshot_creator{isolate};
+				{
+					Locker locker(isolate);
+					Isolate::Scope isolate_scope(isolate);
+					HandleScope handle_scope(isolate);
+					Local<Context> context = Context::New(isolate);
+					snapshot_creator.SetDefaultContext(context, {&SerializeInternalFieldsCallback, nullptr});
+					FunctorRunners::RunCatchExternal(context, [&]() {
+						HandleScope handle_scope(isolate);
+						Local<Context> context_dirty = Context::New(isolate);
+						auto unbound_scripts = RunScripts(context, scripts);
+						if (has_warmup_script) {
+							Context::Scope context_scope{context_dirty};
+							for (auto unbound_script : unbound_scripts) {
+								Unmaybe(unbound_script->BindToCurrentContext()->Run(context_dirty));
+							}
+						}
+						// Extra contexts, which are restored with `Context::FromSnapshot` in index order
+						for (const auto& context_scripts : contexts) {
+							Local<Context> extra_context = Context::New(isolate);
+							RunScripts(extra_context, context_scripts);
+							snapshot_creator.AddContext(extra_context, {&SerializeInternalFieldsCallback, nullptr});
+						}
+						snapshot_creator.AddData(Integer::NewFromUnsigned(isolate, contexts.size()));
+						if (has_warmup_script) {
+							Context::Scope context_scope{context_dirty};
+							MaybeLocal<Object> tmp;
+							ScriptOriginHolder script_origin{tmp};
+							ScriptCompiler::Source source{NewString(warmup_script), ScriptOrigin{script_origin}};
+							RunWithAnnotatedErrors([&context_dirty, &source]() {
+								Unmaybe(Unmaybe(ScriptCompiler::Compile(context_dirty, &source, ScriptCompiler::kNoCompileOptions))->Run(context_dirty));
+							});
+						}
+					}, [ this ](unique_ptr<ExternalCopy> error_inner) {
+						error = std::move(error_inner);
+					});
+					isolate->ContextDisposedNotification(false);
+
+					// Run all queued tasks
+					delegate->DoneWithWork();
+					while (true) {
+						auto task = [&]() -> std::unique_ptr<v8::Task> {
+							auto lock = tasks.write();
+							if (lock->empty()) {
+								return nullptr;
+							}
+							auto task = std::move(lock->front());
+							lock->pop_front();
+							return task;
+						}();
+						if (task) {
+							task->Run();
+						} else {
+							break;
+						}
 					}
-					auto task = std::move(lock->front());
-					lock->pop_front();
-					return task;
-				}();
-				if (task) {
-					task->Run();
-				} else {
-					break;
 				}
+				// nb: Snapshot must be created even in the error case, because `~SnapshotCreator` will crash if
+				// you don't
+				snapshot = snapshot_creator.CreateBlob(SnapshotCreator::FunctionCodeHandling::kKeep);
+			}
+			PlatformDelegate::UnregisterIsolate(isolate);
+			unique_ptr<const char[]> snapshot_data_ptr{snapshot.data};
+			if (error) {
+				return nullptr;
+			} else if (snapshot.raw_size == 0) {
+				error = std::make_shared<ExternalCopyError>(ExternalCopyError::ErrorType::Error, "Failure creating snapshot");
+				return nullptr;
 			}
+			return ArrayBuffer::NewBackingStore(
+				const_cast<char*>(snapshot_data_ptr.release()), snapshot.raw_size,
+				[](void* data, size_t /*length*/, void* /*param*/) { delete[] static_cast<const char*>(data); },
+				nullptr);
 		}
-		// nb: Snapshot must be created even in the error case, because `~SnapshotCreator` will crash if
-		// you don't
-		snapshot = snapshot_creator.CreateBlob(SnapshotCreator::FunctionCodeHandling::kKeep);
-		snapshot_data_ptr.reset(snapshot.data);
-		PlatformDelegate::UnregisterIsolate(isolate);
-	}
 
-	// Export to outer scope
-	if (error) {
-		Isolate::GetCurrent()->ThrowException(error->CopyInto());
+		Scripts scripts;
+		std::vector<Scripts> contexts;
+		std::u16string warmup_script;
+		bool has_warmup_script = false;
+		bool cache;
+		std::string cache_directory;
+};
+
+} // anonymous namespace
+
+auto IsolateHandle::CreateSnapshot(ArrayRange script_handles, MaybeLocal<String> warmup_handle, MaybeLocal<Object> maybe_options) -> Local<Value> {
+	SnapshotJob job{script_handles, warmup_handle, maybe_options};
+	auto snapshot = job.Run();
+	if (!snapshot) {
+		Isolate::GetCurrent()->ThrowException(job.error->CopyInto());
 		return Undefined(Isolate::GetCurrent());
-	} else if (snapshot.raw_size == 0) {
-		throw RuntimeGenericError("Failure creating snapshot");
 	}
-	auto buffer = std::make_shared<ExternalCopyArrayBuffer>((void*)snapshot.data, snapshot.raw_size);
-	return ClassHandle::NewInstance<ExternalCopyHandle>(buffer);
+	return ClassHandle::NewInstance<ExternalCopyHandle>(std::make_shared<ExternalCopyArrayBuffer>(std::move(snapshot)));
+}
+
+/**
+ * Same as `createSnapshot` except the snapshot is built on a background thread
+ */
+auto IsolateHandle::CreateSnapshotAsync(ArrayRange script_handles, MaybeLocal<String> warmup_handle, MaybeLocal<Object> maybe_options) -> Local<Value> {
+	struct ResolveTask : Runnable {
+		ResolveTask(std::unique_ptr<SnapshotJob> job, std::shared_ptr<BackingStore> snapshot, RemoteTuple<Promise::Resolver, Context> resolver) :
+			job{std::move(job)}, snapshot{std::move(snapshot)}, resolver{std::move(resolver)} {}
+
+		void Run() final {
+			auto context = this->resolver.Deref<1>();
+			Context::Scope context_scope{context};
+			auto resolver = this->resolver.Deref<0>();
+			if (snapshot) {
+				auto buffer = std::make_shared<ExternalCopyArrayBuffer>(std::move(snapshot));
+				Unmaybe(resolver->Resolve(context, ClassHandle::NewInstance<ExternalCopyHandle>(std::move(buffer))));
+			} else {
+				Unmaybe(resolver->Reject(context, job->error->CopyInto()));
+			}
+			Isolate::GetCurrent()->PerformMicrotaskCheckpoint();
+		}
+
+		std::unique_ptr<SnapshotJob> job;
+		std::shared_ptr<BackingStore> snapshot;
+		RemoteTuple<Promise::Resolver, Context> resolver;
+	};
+
+	struct BuildTask {
+		std::unique_ptr<SnapshotJob> job;
+		std::shared_ptr<IsolateHolder> holder;
+		std::shared_ptr<IsolateHolder> default_holder;
+		RemoteTuple<Promise::Resolver, Context> resolver;
+	};
+
+	auto job = std::make_unique<SnapshotJob>(script_handles, warmup_handle, maybe_options);
+	auto* isolate = Isolate::GetCurrent();
+	auto context = isolate->GetCurrentContext();
+	auto resolver = Unmaybe(Promise::Resolver::New(context));
+	auto default_holder = Executor::GetDefaultEnvironment().GetHolder().lock();
+
+	// Holding a ref keeps the process alive until the snapshot is ready, and also allows the
+	// background thread to wake the calling isolate. It's taken on the default isolate so that it can
+	// be released even if the calling isolate is disposed in the meantime.
+	LockedScheduler::IncrementUvRefForIsolate(default_holder);
+	auto* task = new BuildTask{
+		std::move(job),
+		IsolateEnvironment::GetCurrentHolder(),
+		std::move(default_holder),
+		RemoteTuple<Promise::Resolver, Context>{resolver, context},
+	};
+	snapshot_threads.exec(snapshot_affinity, [](bool /*pool_thread*/, void* param) {
+		std::unique_ptr<BuildTask> task{static_cast<BuildTask*>(param)};
+		auto snapshot = task->job->Run();
+		task->holder->ScheduleTask(std::make_unique<ResolveTask>(std::move(task->job), std::move(snapshot), std::move(task->resolver)), false, true);
+		LockedScheduler::DecrementUvRefForIsolate(task->default_holder);
+	}, task);
+	return resolver->GetPromise();
 }
 
 } // namespace ivm
@@ -1,11 +1,39 @@
 #pragma once
 #include "isolate/generic/array.h"
 #include "transferable.h"
+#include "isolate/remote_handle.h"
 #include <v8.h>
 #include <memory>
 
 namespace ivm {
 
+class MemoryGroup;
+
+/**
+ * Options passed to `new ivm.Isolate`. These are parsed up front so that isolates can also be built
+ * ahead of time, or away from the calling thread.
+ */
+struct IsolateOptions {
+	IsolateEnvironment::CreateParams params;
+	RemoteHandle<v8::Function> error_handler;
+	RemoteHandle<v8::Function> soft_memory_limit_handler;
+	std::shared_ptr<MemoryGroup> memory_group;
+	size_t memory_floor = 0;
+	size_t soft_memory_limit = 0;
+	uint32_t idle_collection_delay = 0;
+	size_t context_pool_size = 0;
+	size_t eval_cache_size = 0;
+	bool inspector = false;
+
+	explicit IsolateOptions(v8::MaybeLocal<v8::Object> maybe_options);
+
+	/**
+	 * Applies the options which aren't part of `params` to a newly built isolate. This must be called
+	 * before the isolate is handed out.
+	 */
+	void Configure(IsolateHolder& holder) const;
+};
+
 /**
  * Reference to a v8 isolate
  */
@@ -25,15 +53,21 @@ class IsolateHandle : public TransferableHandle {
 		explicit IsolateHandle(std::shared_ptr<IsolateHolder> isolate);
 		static auto Definition() -> v8::Local<v8::FunctionTemplate>;
 		static auto New(v8::MaybeLocal<v8::Object> maybe_options) -> std::unique_ptr<ClassHandle>;
+		static auto Create(v8::MaybeLocal<v8::Object> maybe_options) -> v8::Local<v8::Value>;
 		auto TransferOut() -> std::unique_ptr<Transferable> final;
 
 		template <int async> auto CreateContext(v8::MaybeLocal<v8::Object> maybe_options) -> v8::Local<v8::Value>;
 		template <int async> auto CompileScript(v8::Local<v8::String> code_handle, v8::MaybeLocal<v8::Object> maybe_options) -> v8::Local<v8::Value>;
 		template <int async> auto CompileModule(v8::Local<v8::String> code_handle, v8::MaybeLocal<v8::Object> maybe_options) -> v8::Local<v8::Value>;
+		template <int async> auto CompileModules(ArrayRange entry_handles) -> v8::Local<v8::Value>;
+		auto CompileWasm(v8::Local<v8::Value> source, v8::MaybeLocal<v8::Object> maybe_options) -> v8::Local<v8::Value>;
+		template <int async> auto UnregisterModule(v8::Local<v8::String> specifier) -> v8::Local<v8::Value>;
 
 		auto CreateInspectorSession() -> v8::Local<v8::Value>;
 		auto Dispose() -> v8::Local<v8::Value>;
+		template <int async> auto Hibernate() -> v8::Local<v8::Value>;
 		template <int async> auto GetHeapStatistics() -> v8::Local<v8::Value>;
+		auto GetStatsSnapshot() -> v8::Local<v8::Value>;
 		auto GetCpuTime() -> v8::Local<v8::Value>;
 		auto GetWallTime() -> v8::Local<v8::Value>;
 		auto StartCpuProfiler(v8::Local<v8::String> title) -> v8::Local<v8::Value>;
@@ -41,7 +75,9 @@ class IsolateHandle : public TransferableHandle {
 		
 		auto GetReferenceCount() -> v8::Local<v8::Value>;
 		auto IsDisposedGetter() -> v8::Local<v8::Value>;
-		static auto CreateSnapshot(ArrayRange script_handles, v8::MaybeLocal<v8::String> warmup_handle) -> v8::Local<v8::Value>;
+		auto IsHibernatingGetter() -> v8::Local<v8::Value>;
+		static auto CreateSnapshot(ArrayRange script_handles, v8::MaybeLocal<v8::String> warmup_handle, v8::MaybeLocal<v8::Object> maybe_options) -> v8::Local<v8::Value>;
+		static auto CreateSnapshotAsync(ArrayRange script_handles, v8::MaybeLocal<v8::String> warmup_handle, v8::MaybeLocal<v8::Object> maybe_options) -> v8::Local<v8::Value>;
 };
 
 } // namespace ivm
@@ -0,0 +1,147 @@
+#include "isolate_pool_handle.h"
+
+using namespace v8;
+using std::shared_ptr;
+using std::unique_ptr;
+
+namespace ivm {
+
+/**
+ * IsolatePool implementation
+ */
+IsolatePool::IsolatePool(IsolateOptions options, size_t size) :
+	options{std::move(options)}, size{size} {}
+
+IsolatePool::~IsolatePool() {
+	Close();
+}
+
+auto IsolatePool::Acquire() -> shared_ptr<IsolateHolder> {
+	shared_ptr<IsolateHolder> holder;
+	{
+		auto lock = state.write();
+		if (lock->closed) {
+			throw RuntimeGenericError("IsolatePool is disposed");
+		}
+		if (!lock->ready.empty()) {
+			holder = std::move(lock->ready.front());
+			lock->ready.pop_front();
+		}
+	}
+	if (holder) {
+		++hits;
+		try {
+			options.Configure(*holder);
+		} catch (...) {
+			// Not enough group budget. Put the isolate back for next time.
+			state.write()->ready.push_front(std::move(holder));
+			throw;
+		}
+	} else {
+		// Pool is empty, build this one inline
+		++misses;
+		holder = IsolateEnvironment::New(options.params);
+		options.Configure(*holder);
+	}
+	Refill();
+	return holder;
+}
+
+void IsolatePool::Refill() {
+	size_t count;
+	{
+		auto lock = state.write();
+		if (lock->closed) {
+			return;
+		}
+		count = size - std::min(size, lock->ready.size() + lock->pending);
+		lock->pending += count;
+	}
+	for (size_t ii = 0; ii < count; ++ii) {
+		IsolateEnvironment::NewInBackground(options.params, [weak_pool = weak_from_this()](shared_ptr<IsolateHolder> holder) {
+			auto pool = weak_pool.lock();
+			if (pool) {
+				auto lock = pool->state.write();
+				--lock->pending;
+				if (!lock->closed) {
+					lock->ready.push_back(std::move(holder));
+					return;
+				}
+			}
+			holder->Dispose();
+		});
+	}
+}
+
+void IsolatePool::Close() {
+	auto ready = [&]() {
+		auto lock = state.write();
+		lock->closed = true;
+		return std::exchange(lock->ready, {});
+	}();
+	for (auto& holder : ready) {
+		holder->Dispose();
+	}
+}
+
+/**
+ * IsolatePoolHandle implementation
+ */
+IsolatePoolHandle::IsolatePoolHandle(shared_ptr<IsolatePool> pool) : pool{std::move(pool)} {}
+
+IsolatePoolHandle::~IsolatePoolHandle() {
+	pool->Close();
+}
+
+auto IsolatePoolHandle::Definition() -> Local<FunctionTemplate> {
+	return MakeClass(
+		"IsolatePool", ConstructorFunction<decltype(&IsolatePoolHandle::New), &IsolatePoolHandle::New>{},
+		"acquire", MemberFunction<decltype(&IsolatePoolHandle::Acquire), &IsolatePoolHandle::Acquire>{},
+		"dispose", MemberFunction<decltype(&IsolatePoolHandle::Dispose), &IsolatePoolHandle::Dispose>{},
+		"available", MemberAccessor<decltype(&IsolatePoolHandle::GetAvailable), &IsolatePoolHandle::GetAvailable>{},
+		"hits", MemberAccessor<decltype(&IsolatePoolHandle::GetHits), &IsolatePoolHandle::GetHits>{},
+		"misses", MemberAccessor<decltype(&IsolatePoolHandle::GetMisses), &IsolatePoolHandle::GetMisses>{},
+		"size", MemberAccessor<decltype(&IsolatePoolHandle::GetSize), &IsolatePoolHandle::GetSize>{}
+	);
+}
+
+auto IsolatePoolHandle::New(MaybeLocal<Object> maybe_options) -> unique_ptr<IsolatePoolHandle> {
+	auto size = ReadOption<double>(maybe_options, StringTable::Get().size, 1);
+	if (size < 0) {
+		throw RuntimeRangeError("`size` must not be negative");
+	}
+	IsolateOptions options{ReadOption<MaybeLocal<Object>>(maybe_options, StringTable::Get().isolate, {})};
+	auto pool = std::make_shared<IsolatePool>(std::move(options), static_cast<size_t>(size));
+	pool->Refill();
+	return std::make_unique<IsolatePoolHandle>(std::move(pool));
+}
+
+/**
+ * JS API functions
+ */
+auto IsolatePoolHandle::Acquire() -> Local<Value> {
+	return ClassHandle::NewInstance<IsolateHandle>(pool->Acquire());
+}
+
+auto IsolatePoolHandle::Dispose() -> Local<Value> {
+	pool->Close();
+	return Undefined(Isolate::GetCurrent());
+}
+
+auto IsolatePoolHandle::GetAvailable() -> Local<Value> {
+	return Number::New(Isolate::GetCurrent(), static_cast<double>(pool->GetAvailable()));
+}
+
+auto IsolatePoolHandle::GetHits() -> Local<Value> {
+	return Number::New(Isolate::GetCurrent(), static_cast<double>(pool->GetHits()));
+}
+
+auto IsolatePoolHandle::GetMisses() -> Local<Value> {
+	return Number::New(Isolate::GetCurrent(), static_cast<double>(pool->GetMisses()));
+}
+
+auto IsolatePoolHandle::GetSize() -> Local<Value> {
+	return Number::New(Isolate::GetCurrent(), static_cast<double>(pool->GetSize()));
+}
+
+} // namespace ivm
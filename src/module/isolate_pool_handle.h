@@ -0,0 +1,67 @@
+#pragma once
+#include "isolate_handle.h"
+#include "lib/lockable.h"
+#include <v8.h>
+#include <atomic>
+#include <deque>
+#include <memory>
+
+namespace ivm {
+
+/**
+ * Keeps a number of isolates built from the same options ready to go. Isolates are built on
+ * background threads and the pool is refilled as they are taken.
+ */
+class IsolatePool : public std::enable_shared_from_this<IsolatePool> {
+	public:
+		IsolatePool(IsolateOptions options, size_t size);
+		IsolatePool(const IsolatePool&) = delete;
+		~IsolatePool();
+		auto operator=(const IsolatePool&) = delete;
+
+		auto Acquire() -> std::shared_ptr<IsolateHolder>;
+		void Refill();
+		void Close();
+
+		auto GetAvailable() -> size_t { return state.read()->ready.size(); }
+		auto GetSize() const -> size_t { return size; }
+		auto GetHits() const -> size_t { return hits; }
+		auto GetMisses() const -> size_t { return misses; }
+
+	private:
+		struct State {
+			std::deque<std::shared_ptr<IsolateHolder>> ready;
+			size_t pending = 0;
+			bool closed = false;
+		};
+		IsolateOptions options;
+		size_t size;
+		lockable_t<State> state;
+		std::atomic<size_t> hits{0};
+		std::atomic<size_t> misses{0};
+};
+
+/**
+ * JS handle for `IsolatePool`
+ */
+class IsolatePoolHandle : public ClassHandle {
+	private:
+		std::shared_ptr<IsolatePool> pool;
+
+	public:
+		explicit IsolatePoolHandle(std::shared_ptr<IsolatePool> pool);
+		IsolatePoolHandle(const IsolatePoolHandle&) = delete;
+		~IsolatePoolHandle() final;
+		auto operator=(const IsolatePoolHandle&) = delete;
+		static auto Definition() -> v8::Local<v8::FunctionTemplate>;
+		static auto New(v8::MaybeLocal<v8::Object> maybe_options) -> std::unique_ptr<IsolatePoolHandle>;
+
+		auto Acquire() -> v8::Local<v8::Value>;
+		auto Dispose() -> v8::Local<v8::Value>;
+		auto GetAvailable() -> v8::Local<v8::Value>;
+		auto GetHits() -> v8::Local<v8::Value>;
+		auto GetMisses() -> v8::Local<v8::Value>;
+		auto GetSize() -> v8::Local<v8::Value>;
+};
+
+} // namespace ivm
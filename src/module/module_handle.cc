@@ -1,5 +1,7 @@
 #include "module_handle.h"
 #include "context_handle.h"
+#include "evaluation.h"
+#include "external_copy_handle.h"
 #include "reference_handle.h"
 #include "transferable.h"
 #include "isolate/class_handle.h"
@@ -26,6 +28,20 @@ auto LookupModuleInfo(Local<Module> module) {
 	return it == range.second ? nullptr : it->second;
 }
 
+auto LookupRegisteredModule(Local<String> specifier) -> Local<Module> {
+	auto& registry = IsolateEnvironment::GetCurrent().module_registry;
+	std::string name = *String::Utf8Value{Isolate::GetCurrent(), specifier};
+	auto it = registry.find(name);
+	if (it == registry.end()) {
+		throw RuntimeGenericError("Cannot find module '" + name + "'");
+	}
+	return it->second->handle.Deref();
+}
+
+auto ImportResolved(Local<Object> module_namespace, Local<Value> /*result*/) -> Local<Value> {
+	return module_namespace;
+}
+
 } // anonymous namespace
 
 ModuleInfo::ModuleInfo(Local<Module> handle) : identity_hash{handle->GetIdentityHash()}, handle{handle} {
@@ -47,7 +63,8 @@ ModuleInfo::ModuleInfo(Local<Module> handle) : identity_hash{handle->GetIdentity
 
 ModuleInfo::~ModuleInfo() {
 	// Remove from isolate's list of modules
-	auto environment = handle.GetIsolateHolder()->GetIsolate();
+	// A hibernated isolate took its module map along with it, and shouldn't be rebuilt just for this
+	auto environment = handle.GetIsolateHolder()->GetIsolateIfAwake();
 	if (environment) {
 		auto& module_map = environment->module_handles;
 		auto range = module_map.equal_range(identity_hash);
@@ -70,6 +87,8 @@ ModuleHandle::ModuleHandle(shared_ptr<ModuleInfo> info) : info(std::move(info))
 auto ModuleHandle::Definition() -> Local<FunctionTemplate> {
 	return Inherit<TransferableHandle>(MakeClass(
 		"Module", nullptr,
+		"createCachedData", MemberFunction<decltype(&ModuleHandle::CreateCachedData<1>), &ModuleHandle::CreateCachedData<1>>{},
+		"createCachedDataSync", MemberFunction<decltype(&ModuleHandle::CreateCachedData<0>), &ModuleHandle::CreateCachedData<0>>{},
 		"dependencySpecifiers", MemberAccessor<decltype(&ModuleHandle::GetDependencySpecifiers), &ModuleHandle::GetDependencySpecifiers>{},
 		"instantiate", MemberFunction<decltype(&ModuleHandle::Instantiate), &ModuleHandle::Instantiate>{},
 		"instantiateSync", MemberFunction<decltype(&ModuleHandle::InstantiateSync), &ModuleHandle::InstantiateSync>{},
@@ -119,6 +138,82 @@ void ModuleHandle::InitializeImportMeta(Local<Context> context, Local<Module> mo
 	}
 }
 
+auto ModuleHandle::ImportModuleDynamically(
+	Local<Context> context,
+	Local<Data> /*host_defined_options*/,
+	Local<Value> /*resource_name*/,
+	Local<String> specifier,
+	Local<FixedArray> /*import_attributes*/
+) -> MaybeLocal<Promise> {
+	MaybeLocal<Promise> ret;
+	detail::RunBarrier([&]() {
+		Local<Promise::Resolver> resolver = Unmaybe(Promise::Resolver::New(context));
+		FunctorRunners::RunCatchValue([&]() {
+			Local<Module> mod = LookupRegisteredModule(specifier);
+			auto* info = LookupModuleInfo(mod);
+			assert(info != nullptr);
+			if (mod->GetStatus() == Module::Status::kUninstantiated) {
+				std::lock_guard<std::mutex> lock{info->mutex};
+				InstantiateModule(*info, context);
+			}
+			Local<Promise> evaluation = Unmaybe(mod->Evaluate(context)).As<Promise>();
+			Local<Object> module_namespace = mod->GetModuleNamespace().As<Object>();
+			{
+				std::lock_guard<std::mutex> lock{info->mutex};
+				info->global_namespace = RemoteHandle<Value>(module_namespace);
+			}
+			ret = Unmaybe(evaluation->Then(context, Unmaybe(
+				Function::New(context, FreeFunctionWithData<decltype(&ImportResolved), &ImportResolved>{}.callback, module_namespace)
+			)));
+		}, [&](Local<Value> error) {
+			Unmaybe(resolver->Reject(context, error));
+			ret = resolver->GetPromise();
+		});
+	});
+	return ret;
+}
+
+void ModuleHandle::InstantiateModule(ModuleInfo& info, Local<Context> context) {
+	// nb: `info.mutex` must be held by the caller
+	if (!info.context_handle) {
+		info.context_handle = RemoteHandle<Context>{context};
+	}
+	TryCatch try_catch{Isolate::GetCurrent()};
+	try {
+		Unmaybe(info.handle.Deref()->InstantiateModule(context, ResolveCallback));
+	} catch (...) {
+		try_catch.ReThrow();
+		throw;
+	}
+	// `InstantiateModule` will return Maybe<bool>{true} even when there are exceptions pending.
+	// This condition is checked here and a C++ is thrown which will propagate out as a JS
+	// exception.
+	if (try_catch.HasCaught()) {
+		try_catch.ReThrow();
+		throw RuntimeError();
+	}
+}
+
+auto ModuleHandle::ResolveCallback(Local<Context> /*context*/, Local<String> specifier, Local<FixedArray> /*import_assertions*/, Local<Module> referrer) -> MaybeLocal<Module> {
+	MaybeLocal<Module> ret;
+	detail::RunBarrier([&]() {
+		// Lookup ModuleInfo* instance from `referrer`
+		ModuleInfo* found = LookupModuleInfo(referrer);
+		if (found != nullptr) {
+			// nb: lock is already acquired in `Instantiate`
+			auto& resolutions = found->resolutions;
+			auto it = resolutions.find(*String::Utf8Value{Isolate::GetCurrent(), specifier});
+			if (it != resolutions.end()) {
+				ret = it->second->handle.Deref();
+				return;
+			}
+		}
+		// Anything not given by a `resolve` callback comes from the isolate's module registry
+		ret = LookupRegisteredModule(specifier);
+	});
+	return ret;
+}
+
 /**
  * Implements the module linking logic used by `instantiate`. This is implemented as a class handle
  * so v8 can manage the lifetime of the linker. If a promise fails to resolve then v8 will be
@@ -244,33 +339,17 @@ struct InstantiateRunner : public ThreePhaseTask {
 	shared_ptr<ModuleInfo> info;
 	RemoteHandle<Object> linker;
 
-	static auto ResolveCallback(Local<Context> /*context*/, Local<String> specifier, Local<FixedArray> /*import_assertions*/, Local<Module> referrer) -> MaybeLocal<Module> {
-		MaybeLocal<Module> ret;
-		detail::RunBarrier([&]() {
-			// Lookup ModuleInfo* instance from `referrer`
-			ModuleInfo* found = LookupModuleInfo(referrer);
-			if (found != nullptr) {
-				// nb: lock is already acquired in `Instantiate`
-				auto& resolutions = found->resolutions;
-				auto it = resolutions.find(*String::Utf8Value{Isolate::GetCurrent(), specifier});
-				if (it != resolutions.end()) {
-					ret = it->second->handle.Deref();
-					return;
-				}
-			}
-			throw RuntimeGenericError("Dependency was left unresolved. Please report this error on github.");
-		});
-		return ret;
-	}
-
 	InstantiateRunner(
 		RemoteHandle<Context> context,
 		shared_ptr<ModuleInfo> info,
-		Local<Object> linker
+		MaybeLocal<Object> linker
 	) :
 		context(std::move(context)),
-		info(std::move(info)),
-		linker(linker) {
+		info(std::move(info)) {
+		Local<Object> linker_handle;
+		if (linker.ToLocal(&linker_handle)) {
+			this->linker = RemoteHandle<Object>{linker_handle};
+		}
 		// Sanity check
 		if (this->info->handle.GetIsolateHolder() != this->context.GetIsolateHolder()) {
 			throw RuntimeGenericError("Invalid context");
@@ -278,28 +357,16 @@ struct InstantiateRunner : public ThreePhaseTask {
 	}
 
 	void Phase2() final {
-		Local<Module> mod = info->handle.Deref();
 		Local<Context> context_local = context.Deref();
 		info->context_handle = std::move(context);
 		std::lock_guard<std::mutex> lock{info->mutex};
-		TryCatch try_catch{Isolate::GetCurrent()};
-		try {
-			Unmaybe(mod->InstantiateModule(context_local, ResolveCallback));
-		} catch (...) {
-			try_catch.ReThrow();
-			throw;
-		}
-		// `InstantiateModule` will return Maybe<bool>{true} even when there are exceptions pending.
-		// This condition is checked here and a C++ is thrown which will propagate out as a JS
-		// exception.
-		if (try_catch.HasCaught()) {
-			try_catch.ReThrow();
-			throw RuntimeError();
-		}
+		ModuleHandle::InstantiateModule(*info, context_local);
 	}
 
 	auto Phase3() -> Local<Value> final {
-		ClassHandle::Unwrap<ModuleLinker>(linker.Deref())->Reset(ModuleInfo::LinkStatus::Linked);
+		if (linker) {
+			ClassHandle::Unwrap<ModuleLinker>(linker.Deref())->Reset(ModuleInfo::LinkStatus::Linked);
+		}
 		return Undefined(Isolate::GetCurrent());
 	}
 };
@@ -433,16 +500,26 @@ class ModuleLinkerAsync : public ModuleLinker::Implementation {
 		}
 };
 
-auto ModuleHandle::Instantiate(ContextHandle& context_handle, Local<Function> callback) -> Local<Value> {
+auto ModuleHandle::Instantiate(ContextHandle& context_handle, MaybeLocal<Function> maybe_callback) -> Local<Value> {
 	auto context = context_handle.GetContext();
+	Local<Function> callback;
+	if (!maybe_callback.ToLocal(&callback)) {
+		auto info = GetInfo();
+		return ThreePhaseTask::Run<1, InstantiateRunner>(*info->handle.GetIsolateHolder(), context, info, MaybeLocal<Object>{});
+	}
 	Local<Object> linker_handle = ClassHandle::NewInstance<ModuleLinker>(callback);
 	auto* linker = ClassHandle::Unwrap<ModuleLinker>(linker_handle);
 	linker->SetImplementation<ModuleLinkerAsync>();
 	return linker->Begin(*this, context);
 }
 
-auto ModuleHandle::InstantiateSync(ContextHandle& context_handle, Local<Function> callback) -> Local<Value> {
+auto ModuleHandle::InstantiateSync(ContextHandle& context_handle, MaybeLocal<Function> maybe_callback) -> Local<Value> {
 	auto context = context_handle.GetContext();
+	Local<Function> callback;
+	if (!maybe_callback.ToLocal(&callback)) {
+		auto info = GetInfo();
+		return ThreePhaseTask::Run<0, InstantiateRunner>(*info->handle.GetIsolateHolder(), context, info, MaybeLocal<Object>{});
+	}
 	Local<Object> linker_handle = ClassHandle::NewInstance<ModuleLinker>(callback);
 	auto* linker = ClassHandle::Unwrap<ModuleLinker>(linker_handle);
 	linker->SetImplementation<ModuleLinkerSync>();
@@ -484,6 +561,32 @@ auto ModuleHandle::Evaluate(MaybeLocal<Object> maybe_options) -> Local<Value> {
 	return ThreePhaseTask::Run<async, EvaluateRunner>(*info->handle.GetIsolateHolder(), info, timeout_ms);
 }
 
+struct CreateModuleCachedDataRunner : public ThreePhaseTask {
+	shared_ptr<ModuleInfo> info;
+	shared_ptr<ExternalCopyArrayBuffer> cached_data;
+
+	explicit CreateModuleCachedDataRunner(shared_ptr<ModuleInfo> info) : info(std::move(info)) {}
+
+	void Phase2() final {
+		Local<Module> mod = info->handle.Deref();
+		auto backing_store = AdoptCachedData(ScriptCompiler::CreateCodeCache(mod->GetUnboundModuleScript()));
+		if (!backing_store) {
+			throw RuntimeGenericError("Failed to create cached data");
+		}
+		cached_data = std::make_shared<ExternalCopyArrayBuffer>(std::move(backing_store));
+	}
+
+	auto Phase3() -> Local<Value> final {
+		return ClassHandle::NewInstance<ExternalCopyHandle>(std::move(cached_data));
+	}
+};
+
+template <int async>
+auto ModuleHandle::CreateCachedData() -> Local<Value> {
+	auto info = GetInfo();
+	return ThreePhaseTask::Run<async, CreateModuleCachedDataRunner>(*info->handle.GetIsolateHolder(), info);
+}
+
 auto ModuleHandle::GetNamespace() -> Local<Value> {
 	std::lock_guard<std::mutex> lock(info->mutex);
 	if (!info->global_namespace) {
@@ -54,14 +54,27 @@ class ModuleHandle : public TransferableHandle {
 		auto GetInfo() const -> std::shared_ptr<ModuleInfo>;
 		auto Release() -> v8::Local<v8::Value>;
 
-		auto Instantiate(class ContextHandle& context_handle, v8::Local<v8::Function> callback) -> v8::Local<v8::Value>;
-		auto InstantiateSync(class ContextHandle& context_handle, v8::Local<v8::Function> callback) -> v8::Local<v8::Value>;
+		auto Instantiate(class ContextHandle& context_handle, v8::MaybeLocal<v8::Function> maybe_callback) -> v8::Local<v8::Value>;
+		auto InstantiateSync(class ContextHandle& context_handle, v8::MaybeLocal<v8::Function> maybe_callback) -> v8::Local<v8::Value>;
 
 		template <int async>
 		auto Evaluate(v8::MaybeLocal<v8::Object> maybe_options) -> v8::Local<v8::Value>;
 
+		template <int async>
+		auto CreateCachedData() -> v8::Local<v8::Value>;
+
 		auto GetNamespace() -> v8::Local<v8::Value>;
 
+		static void InstantiateModule(ModuleInfo& info, v8::Local<v8::Context> context);
+		static auto ResolveCallback(
+			v8::Local<v8::Context> context, v8::Local<v8::String> specifier,
+			v8::Local<v8::FixedArray> import_assertions, v8::Local<v8::Module> referrer
+		) -> v8::MaybeLocal<v8::Module>;
+		static auto ImportModuleDynamically(
+			v8::Local<v8::Context> context, v8::Local<v8::Data> host_defined_options,
+			v8::Local<v8::Value> resource_name, v8::Local<v8::String> specifier,
+			v8::Local<v8::FixedArray> import_attributes
+		) -> v8::MaybeLocal<v8::Promise>;
 		static void InitializeImportMeta(v8::Local<v8::Context> context, v8::Local<v8::Module> module, v8::Local<v8::Object> meta);
 };
 
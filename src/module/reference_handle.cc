@@ -342,7 +342,7 @@ class ApplyRunner : public ThreePhaseTask {
 			ApplyRunner& self = *reinterpret_cast<ApplyRunner*>(info[0].As<External>()->Value());
 			if (info.Length() == 3) {
 				// Resolved
-				FunctorRunners::RunCatchExternal(IsolateEnvironment::GetCurrent().DefaultContext(), [&self, &info]() {
+				FunctorRunners::RunCatchExternal([]() { return IsolateEnvironment::GetCurrent().DefaultContext(); }, [&self, &info]() {
 					self.ret = TransferOut(info[2]);
 				}, [&self](unique_ptr<ExternalCopy> error) {
 					self.async_error = std::move(error);
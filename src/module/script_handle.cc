@@ -1,6 +1,8 @@
 #include "isolate/run_with_timeout.h"
 #include "isolate/three_phase_task.h"
 #include "context_handle.h"
+#include "evaluation.h"
+#include "external_copy_handle.h"
 #include "script_handle.h"
 
 using namespace v8;
@@ -16,6 +18,8 @@ ScriptHandle::ScriptHandle(RemoteHandle<UnboundScript> script) :
 auto ScriptHandle::Definition() -> Local<FunctionTemplate> {
 	return Inherit<TransferableHandle>(MakeClass(
 		"Script", nullptr,
+		"createCachedData", MemberFunction<decltype(&ScriptHandle::CreateCachedData<1>), &ScriptHandle::CreateCachedData<1>>{},
+		"createCachedDataSync", MemberFunction<decltype(&ScriptHandle::CreateCachedData<0>), &ScriptHandle::CreateCachedData<0>>{},
 		"release", MemberFunction<decltype(&ScriptHandle::Release), &ScriptHandle::Release>{},
 		"run", MemberFunction<decltype(&ScriptHandle::Run<1>), &ScriptHandle::Run<1>>{},
 		"runIgnored", MemberFunction<decltype(&ScriptHandle::Run<2>), &ScriptHandle::Run<2>>{},
@@ -32,6 +36,36 @@ auto ScriptHandle::Release() -> Local<Value> {
 	return Undefined(Isolate::GetCurrent());
 }
 
+/*
+ * Produce cached data for this script, including any functions which have been compiled since
+ */
+struct CreateScriptCachedDataRunner : public ThreePhaseTask {
+	explicit CreateScriptCachedDataRunner(RemoteHandle<UnboundScript>& script) : script{script} {
+		if (!script) {
+			throw RuntimeGenericError("Script has been released");
+		}
+	}
+
+	void Phase2() final {
+		auto backing_store = AdoptCachedData(ScriptCompiler::CreateCodeCache(Deref(script)));
+		if (!backing_store) {
+			throw RuntimeGenericError("Failed to create cached data");
+		}
+		cached_data = std::make_shared<ExternalCopyArrayBuffer>(std::move(backing_store));
+	}
+
+	auto Phase3() -> Local<Value> final {
+		return ClassHandle::NewInstance<ExternalCopyHandle>(std::move(cached_data));
+	}
+
+	RemoteHandle<UnboundScript> script;
+	std::shared_ptr<ExternalCopyArrayBuffer> cached_data;
+};
+template <int async>
+auto ScriptHandle::CreateCachedData() -> Local<Value> {
+	return ThreePhaseTask::Run<async, CreateScriptCachedDataRunner>(*script.GetIsolateHolder(), script);
+}
+
 /*
  * Run this script in a given context
  */
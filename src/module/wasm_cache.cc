@@ -0,0 +1,206 @@
+#include "wasm_cache.h"
+#include "isolate/environment.h"
+#include "lib/lockable.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <list>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+using namespace v8;
+
+namespace ivm {
+namespace {
+
+using Bytes = MemorySpan<const uint8_t>;
+
+struct Entry {
+	size_t hash;
+	CompiledWasmModule module;
+};
+
+struct State {
+	// Most recently used first. There are only ever a handful of modules so this is searched linearly.
+	std::list<Entry> entries;
+	size_t max_entries = 0;
+
+	auto Find(size_t hash, Bytes bytes) {
+		return std::find_if(entries.begin(), entries.end(), [&](Entry& entry) {
+			if (entry.hash != hash) {
+				return false;
+			}
+			auto wire_bytes = entry.module.GetWireBytesRef();
+			return wire_bytes.size() == bytes.size() && std::memcmp(wire_bytes.data(), bytes.data(), bytes.size()) == 0;
+		});
+	}
+
+	void Trim() {
+		while (entries.size() > max_entries) {
+			entries.pop_back();
+		}
+	}
+};
+
+lockable_t<State> state;
+std::atomic<size_t> max_entries{0};
+std::atomic<size_t> hits{0};
+std::atomic<size_t> misses{0};
+
+auto Hash(Bytes bytes) -> size_t {
+	return std::hash<std::string_view>{}({ reinterpret_cast<const char*>(bytes.data()), bytes.size() });
+}
+
+// Same as what the WebAssembly constructors accept, except SharedArrayBuffer which may change under us
+auto GetBytes(Local<Value> value) -> std::optional<Bytes> {
+	if (value->IsArrayBuffer()) {
+		auto buffer = value.As<ArrayBuffer>();
+		return Bytes{ static_cast<const uint8_t*>(buffer->Data()), buffer->ByteLength() };
+	} else if (value->IsArrayBufferView()) {
+		auto view = value.As<ArrayBufferView>();
+		auto buffer = view->Buffer();
+		if (buffer->IsSharedArrayBuffer()) {
+			return {};
+		}
+		return Bytes{ static_cast<const uint8_t*>(buffer->Data()) + view->ByteOffset(), view->ByteLength() };
+	}
+	return {};
+}
+
+auto Lookup(Bytes bytes) -> std::optional<CompiledWasmModule> {
+	auto hash = Hash(bytes);
+	auto lock = state.write();
+	auto it = lock->Find(hash, bytes);
+	if (it == lock->entries.end()) {
+		++misses;
+		return {};
+	}
+	++hits;
+	lock->entries.splice(lock->entries.begin(), lock->entries, it);
+	return it->module;
+}
+
+void Insert(CompiledWasmModule module) {
+	auto bytes = module.GetWireBytesRef();
+	auto hash = Hash(bytes);
+	auto lock = state.write();
+	if (lock->max_entries == 0) {
+		return;
+	}
+	auto it = lock->Find(hash, bytes);
+	if (it != lock->entries.end()) {
+		lock->entries.erase(it);
+	}
+	lock->entries.push_front({ hash, std::move(module) });
+	lock->Trim();
+}
+
+void StoreCompiled(const FunctionCallbackInfo<Value>& info) {
+	if (info[0]->IsWasmModuleObject()) {
+		Insert(info[0].As<WasmModuleObject>()->GetCompiledModule());
+	}
+	info.GetReturnValue().Set(info[0]);
+}
+
+// Replacement for `WebAssembly.compile`. The original is in `info.Data()`.
+void Compile(const FunctionCallbackInfo<Value>& info) {
+	Isolate* isolate = info.GetIsolate();
+	Local<Context> context = isolate->GetCurrentContext();
+	bool enabled = max_entries != 0;
+	if (enabled) {
+		auto bytes = GetBytes(info[0]);
+		auto compiled = bytes ? Lookup(*bytes) : std::nullopt;
+		if (compiled) {
+			Local<Promise::Resolver> resolver;
+			Local<WasmModuleObject> module;
+			if (Promise::Resolver::New(context).ToLocal(&resolver) &&
+				WasmModuleObject::FromCompiledModule(isolate, *compiled).ToLocal(&module) &&
+				resolver->Resolve(context, module).IsJust()
+			) {
+				info.GetReturnValue().Set(resolver->GetPromise());
+			}
+			return;
+		}
+	}
+	std::vector<Local<Value>> argv(info.Length());
+	for (int ii = 0; ii < info.Length(); ++ii) {
+		argv[ii] = info[ii];
+	}
+	Local<Value> result;
+	if (!info.Data().As<Function>()->Call(context, info.This(), argv.size(), argv.data()).ToLocal(&result)) {
+		return;
+	}
+	Local<Function> store;
+	if (enabled && result->IsPromise() && Function::New(context, StoreCompiled).ToLocal(&store)) {
+		Local<Promise> then;
+		if (!result.As<Promise>()->Then(context, store).ToLocal(&then)) {
+			return;
+		}
+		result = then;
+	}
+	info.GetReturnValue().Set(result);
+}
+
+} // anonymous namespace
+
+void WasmCache::SetMaxEntries(size_t size) {
+	auto lock = state.write();
+	lock->max_entries = size;
+	max_entries = size;
+	lock->Trim();
+}
+
+void WasmCache::Clear() {
+	state.write()->entries.clear();
+}
+
+auto WasmCache::GetStatistics() -> Statistics {
+	auto lock = state.read();
+	return { lock->entries.size(), lock->max_entries, hits, misses };
+}
+
+auto WasmCache::ModuleCallback(const FunctionCallbackInfo<Value>& info) -> bool {
+	if (max_entries == 0 || !info.IsConstructCall()) {
+		return false;
+	}
+	auto bytes = GetBytes(info[0]);
+	if (!bytes) {
+		return false;
+	}
+	Isolate* isolate = info.GetIsolate();
+	MaybeLocal<WasmModuleObject> module;
+	auto compiled = Lookup(*bytes);
+	if (compiled) {
+		module = WasmModuleObject::FromCompiledModule(isolate, *compiled);
+	} else {
+		module = WasmModuleObject::Compile(isolate, *bytes);
+	}
+	Local<WasmModuleObject> handle;
+	if (module.ToLocal(&handle)) {
+		if (!compiled) {
+			Insert(handle->GetCompiledModule());
+		}
+		info.GetReturnValue().Set(handle);
+	}
+	// Otherwise there's an exception pending which v8 will throw
+	return true;
+}
+
+void WasmCache::InstallCompile(Local<Context> context) {
+	auto& strings = StringTable::Get();
+	Local<Value> web_assembly;
+	Local<Value> compile;
+	Local<Function> wrapper;
+	if (
+		context->Global()->Get(context, strings.WebAssembly).ToLocal(&web_assembly) && web_assembly->IsObject() &&
+		web_assembly.As<Object>()->Get(context, strings.compile).ToLocal(&compile) && compile->IsFunction() &&
+		Function::New(context, Compile, compile, 1, ConstructorBehavior::kThrow).ToLocal(&wrapper)
+	) {
+		wrapper->SetName(strings.compile);
+		Unmaybe(web_assembly.As<Object>()->Set(context, strings.compile, wrapper));
+	}
+}
+
+} // namespace ivm
@@ -0,0 +1,33 @@
+#pragma once
+#include <v8.h>
+#include <cstddef>
+
+namespace ivm {
+
+/**
+ * Process-wide store of compiled WebAssembly modules which is shared by every isolate. Entries are
+ * keyed by a hash of the module's bytes, and the least recently used modules are evicted once there
+ * are more than `max_entries`. The cache is disabled while `max_entries` is 0, which is the default.
+ */
+class WasmCache {
+	public:
+		struct Statistics {
+			size_t entries = 0;
+			size_t max_entries = 0;
+			size_t hits = 0;
+			size_t misses = 0;
+		};
+
+		static void SetMaxEntries(size_t max_entries);
+		static auto GetStatistics() -> Statistics;
+		// Isolates can't shut down while they still have modules in the cache, so this must be called
+		// before the process exits
+		static void Clear();
+
+		// Installed with `SetWasmModuleCallback`, this handles `new WebAssembly.Module(bytes)`
+		static auto ModuleCallback(const v8::FunctionCallbackInfo<v8::Value>& info) -> bool;
+		// v8 has no such hook for `WebAssembly.compile` so it's wrapped in each new context instead
+		static void InstallCompile(v8::Local<v8::Context> context);
+};
+
+} // namespace ivm
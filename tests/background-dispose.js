@@ -0,0 +1,23 @@
+'use strict';
+const ivm = require('isolated-vm');
+const assert = require('assert');
+
+(async function() {
+	// Build up a large heap which would be slow to tear down
+	const isolate = new ivm.Isolate({ memoryLimit: 256 });
+	const context = isolate.createContextSync();
+	context.evalSync('globalThis.storage = Array(1024 * 512).fill().map(() => ({}))');
+	const disposed = isolate.dispose();
+	assert.ok(disposed instanceof Promise);
+	assert.ok(isolate.isDisposed);
+	assert.throws(() => context.evalSync('1'), /disposed/);
+	assert.throws(() => isolate.dispose(), /already disposed/);
+	await disposed;
+
+	// Disposing many isolates at once
+	await Promise.all(Array(8).fill().map(() => new ivm.Isolate().dispose()));
+
+	// Pending disposal doesn't hold the process open forever
+	new ivm.Isolate().dispose();
+	console.log('pass');
+})().catch(console.error);
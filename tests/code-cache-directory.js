@@ -0,0 +1,54 @@
+'use strict';
+const ivm = require('isolated-vm');
+const assert = require('assert');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { spawnSync } = require('child_process');
+
+// Each run is a separate process so the only thing shared is the directory
+if (process.argv[2]) {
+	ivm.setCodeCacheDirectory(process.argv[2]);
+	const value = Number(process.argv[3] || 42);
+	const isolate = new ivm.Isolate;
+	const script = isolate.compileScriptSync(`function fn() { return ${value}; } fn()`, { filename: 'dir.js' });
+	assert.strictEqual(script.runSync(isolate.createContextSync()), value);
+	const stats = ivm.getCodeCacheStatistics();
+	process.stdout.write(JSON.stringify({ hits: stats.hits, misses: stats.misses }));
+	return;
+}
+
+const directory = fs.mkdtempSync(path.join(os.tmpdir(), 'ivm-code-cache-'));
+try {
+	const run = (...args) => {
+		const result = spawnSync(process.execPath, [ ...process.execArgv, __filename, directory, ...args ], { encoding: 'utf8' });
+		assert.strictEqual(result.status, 0, result.stderr);
+		return JSON.parse(result.stdout);
+	};
+	assert.deepStrictEqual(run(), { hits: 0, misses: 1 });
+	const files = fs.readdirSync(directory);
+	assert.strictEqual(files.length, 1);
+	assert.ok(files[0].endsWith('.code'));
+	assert.deepStrictEqual(run(), { hits: 1, misses: 0 });
+
+	// Garbage is rejected by v8, counted as a miss, and replaced
+	fs.writeFileSync(path.join(directory, files[0]), Buffer.alloc(64, 1));
+	assert.deepStrictEqual(run(), { hits: 0, misses: 1 });
+	assert.ok(fs.statSync(path.join(directory, files[0])).size > 64);
+	assert.deepStrictEqual(run(), { hits: 1, misses: 0 });
+	assert.deepStrictEqual(fs.readdirSync(directory), files);
+
+	// An entry saved for different source of the same length isn't used, even under this file's name
+	assert.deepStrictEqual(run(43), { hits: 0, misses: 1 });
+	const other = fs.readdirSync(directory).find(file => file !== files[0]);
+	fs.copyFileSync(path.join(directory, other), path.join(directory, files[0]));
+	assert.deepStrictEqual(run(), { hits: 0, misses: 1 });
+	assert.deepStrictEqual(run(), { hits: 1, misses: 0 });
+	fs.unlinkSync(path.join(directory, other));
+
+	assert.throws(() => ivm.setCodeCacheDirectory(path.join(directory, files[0])), /not a directory/);
+	assert.throws(() => ivm.setCodeCacheDirectory(''), TypeError);
+	console.log('pass');
+} finally {
+	fs.rmSync(directory, { recursive: true, force: true });
+}
@@ -0,0 +1,51 @@
+'use strict';
+const ivm = require('isolated-vm');
+const assert = require('assert');
+
+const code = `function fn() { return ${'1 + '.repeat(1000)}1; } fn();`;
+const compile = (isolate, options) => isolate.compileScriptSync(code, { filename: 'lib.js', ...options });
+
+// Disabled by default
+compile(new ivm.Isolate);
+assert.deepStrictEqual(ivm.getCodeCacheStatistics(), { entries: 0, size: 0, maxSize: 0, hits: 0, misses: 0 });
+
+ivm.setCodeCache({ maxSize: 1 });
+
+// First compile misses and fills the cache
+const first = new ivm.Isolate;
+assert.strictEqual(compile(first).runSync(first.createContextSync()), 1001);
+let stats = ivm.getCodeCacheStatistics();
+assert.strictEqual(stats.misses, 1);
+assert.strictEqual(stats.entries, 1);
+assert.ok(stats.size > 0);
+
+// Other isolates hit it
+const second = new ivm.Isolate;
+assert.strictEqual(compile(second).runSync(second.createContextSync()), 1001);
+assert.strictEqual(ivm.getCodeCacheStatistics().hits, 1);
+
+// Different origins don't share entries
+compile(second, { filename: 'other.js' });
+assert.strictEqual(ivm.getCodeCacheStatistics().entries, 2);
+
+// Explicit `cachedData` bypasses the shared cache, `produceCachedData` still works
+const script = compile(second, { produceCachedData: true });
+assert.ok(script.cachedData instanceof ivm.ExternalCopy);
+compile(second, { cachedData: script.cachedData });
+stats = ivm.getCodeCacheStatistics();
+assert.strictEqual(stats.hits, 2);
+assert.strictEqual(stats.misses, 2);
+
+// Modules
+const modules = new ivm.Isolate;
+modules.compileModuleSync('export default 1;');
+modules.compileModuleSync('export default 1;');
+assert.strictEqual(ivm.getCodeCacheStatistics().hits, 3);
+
+// Eviction
+ivm.setCodeCache({ maxSize: stats.size / 2 / 1024 / 1024 });
+assert.ok(ivm.getCodeCacheStatistics().entries < 3);
+ivm.setCodeCache();
+assert.strictEqual(ivm.getCodeCacheStatistics().entries, 0);
+assert.throws(() => ivm.setCodeCache({ maxSize: -1 }), RangeError);
+console.log('pass');
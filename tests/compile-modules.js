@@ -0,0 +1,63 @@
+'use strict';
+const ivm = require('isolated-vm');
+const assert = require('assert');
+
+const graph = [
+	{ specifier: 'main', code: 'import { double } from "math"; import { value } from "value"; export default double(value);' },
+	{ specifier: 'math', code: 'export function double(x) { return x * 2; }' },
+	{ specifier: 'value', code: 'export const value = 21;', filename: 'value.js' },
+];
+
+(async function() {
+	const isolate = new ivm.Isolate;
+	const context = await isolate.createContext();
+
+	// Compile, link and run a graph
+	const modules = await isolate.compileModules(graph.map(entry => ({ ...entry, produceCachedData: true })));
+	assert.strictEqual(modules.length, 3);
+	assert.deepStrictEqual(modules[0].dependencySpecifiers, [ 'math', 'value' ]);
+	await modules[0].instantiate(context);
+	await modules[0].evaluate();
+	assert.strictEqual(await modules[0].namespace.get('default', { copy: true }), 42);
+	for (const module of modules) {
+		assert.ok(module.cachedData instanceof ivm.ExternalCopy);
+	}
+
+	// Cached data round trip, in another isolate
+	const other = new ivm.Isolate;
+	const consumed = other.compileModulesSync(graph.map((entry, ii) => ({ ...entry, cachedData: modules[ii].cachedData })));
+	for (const module of consumed) {
+		assert.strictEqual(module.cachedDataRejected, false);
+	}
+	const otherContext = other.createContextSync();
+	consumed[0].instantiateSync(otherContext);
+	consumed[0].evaluateSync();
+	assert.strictEqual(consumed[0].namespace.getSync('default'), 42);
+
+	// Errors
+	assert.throws(() => isolate.compileModulesSync([ { code: '' } ]), /`specifier` property is required/);
+	assert.throws(() => isolate.compileModulesSync([ { specifier: 'a' } ]), /`code` property is required/);
+	assert.throws(() => isolate.compileModulesSync([ { specifier: 'a', code: '' }, { specifier: 'a', code: '' } ]), /Duplicate specifier 'a'/);
+	await assert.rejects(isolate.compileModules([
+		{ specifier: 'value', code: 'export const value = 1;' },
+		{ specifier: 'bad', code: 'export let', filename: 'bad.js' },
+	]), /SyntaxError.*\[bad\.js:1:11\]/);
+	// .. the failed batch didn't replace anything
+	assert.strictEqual(await context.eval('import("value").then(ns => ns.value)', { promise: true }), 21);
+
+	// `meta` callbacks, which have to come from the isolate itself
+	assert.throws(() => isolate.compileModulesSync([ { specifier: 'a', code: '', meta() {} } ]), /`meta` callback/);
+	assert.strictEqual(context.evalClosureSync(`
+		const [ module ] = $0.compileModulesSync([ {
+			specifier: 'meta',
+			code: 'export default import.meta.url',
+			meta: meta => { meta.url = 'pass' },
+		} ]);
+		module.instantiateSync($1, () => {});
+		module.evaluateSync();
+		return module.namespace.deref().default;
+	`, [ isolate, context ]), 'pass');
+
+	assert.deepStrictEqual(await isolate.compileModules([]), []);
+	console.log('pass');
+})().catch(console.error);
@@ -0,0 +1,38 @@
+'use strict';
+const ivm = require('isolated-vm');
+const assert = require('assert');
+
+const snapshot = ivm.Isolate.createSnapshot([ { code: 'globalThis.fromSnapshot = true' } ]);
+const isolate = new ivm.Isolate({ contextPoolSize: 2, snapshot });
+assert.throws(() => new ivm.Isolate({ contextPoolSize: -1 }), RangeError);
+
+(async function() {
+	// Contexts from the pool are fresh and built from the snapshot
+	for (let ii = 0; ii < 10; ++ii) {
+		const context = await isolate.createContext();
+		assert.strictEqual(context.evalSync('globalThis.fromSnapshot'), true);
+		assert.strictEqual(context.evalSync('typeof leaked'), 'undefined');
+		context.evalSync('globalThis.leaked = 1');
+		context.release();
+	}
+
+	// Sync creation works too, and contexts are independent
+	const contexts = Array(5).fill().map(() => isolate.createContextSync());
+	contexts.forEach((context, ii) => context.global.setSync('id', ii));
+	contexts.forEach((context, ii) => assert.strictEqual(context.global.getSync('id'), ii));
+	contexts.forEach(context => context.release());
+
+	// Trimming memory throws away spare contexts, but they come back
+	ivm.trimMemory();
+	const context = await isolate.createContext();
+	assert.strictEqual(context.evalSync('1 + 1'), 2);
+	isolate.dispose();
+
+	// Spare contexts count against the memory limit
+	const greedy = new ivm.Isolate({ memoryLimit: 8, contextPoolSize: 500 });
+	for (let ii = 0; ii < 100 && !greedy.isDisposed; ++ii) {
+		await new Promise(resolve => setTimeout(resolve, 50));
+	}
+	assert.strictEqual(greedy.isDisposed, true);
+	console.log('pass');
+})().catch(console.error);
@@ -0,0 +1,39 @@
+'use strict';
+const ivm = require('isolated-vm');
+const assert = require('assert');
+
+const code = Array.from({ length: 200 }, (_, ii) => `function fn${ii}() { return ${ii}; }`).join('\n') +
+	'\nglobalThis.warmup = () => { let sum = 0; for (let ii = 0; ii < 200; ++ii) sum += globalThis[`fn${ii}`](); return sum; };';
+
+(async function() {
+	// Cached data taken after warmup includes the lazily compiled functions, so it's bigger
+	const isolate = new ivm.Isolate;
+	const context = isolate.createContextSync();
+	const script = isolate.compileScriptSync(code, { produceCachedData: true });
+	script.runSync(context);
+	assert.strictEqual(context.evalSync('warmup()'), 19900);
+	const warm = await script.createCachedData();
+	assert.ok(warm instanceof ivm.ExternalCopy);
+	assert.ok(warm.copy().byteLength > script.cachedData.copy().byteLength);
+	assert.ok(script.createCachedDataSync().copy().byteLength > 0);
+
+	// And can be consumed by another isolate
+	const other = new ivm.Isolate;
+	const otherContext = other.createContextSync();
+	const consumed = other.compileScriptSync(code, { cachedData: warm });
+	assert.strictEqual(consumed.cachedDataRejected, false);
+	consumed.runSync(otherContext);
+	assert.strictEqual(otherContext.evalSync('warmup()'), 19900);
+
+	// Modules
+	const module = isolate.compileModuleSync(`${code}\nexport default warmup();`, { produceCachedData: true });
+	module.instantiateSync(context, () => { throw new Error; });
+	module.evaluateSync();
+	const moduleData = module.createCachedDataSync();
+	assert.ok(moduleData.copy().byteLength > module.cachedData.copy().byteLength);
+	assert.strictEqual(other.compileModuleSync(`${code}\nexport default warmup();`, { cachedData: moduleData }).cachedDataRejected, false);
+
+	script.release();
+	assert.throws(() => script.createCachedDataSync(), /released/);
+	console.log('pass');
+})().catch(console.error);
@@ -0,0 +1,31 @@
+'use strict';
+const ivm = require('isolated-vm');
+const assert = require('assert');
+
+const code = Array.from({ length: 200 }, (_, ii) => `function fn${ii}(a) { return a.map(x => x * ${ii}).reduce((x, y) => x + y, 0); }`).join('\n') + '\nfn10([ 1, 2 ])';
+
+(async function() {
+	const isolate = new ivm.Isolate;
+	const context = await isolate.createContext();
+
+	// Sync and streamed compiles both include every function body in the cached data. Each uses a new
+	// isolate so v8's own compilation cache doesn't hand back the lazy result.
+	const lazy = new ivm.Isolate().compileScriptSync(code, { produceCachedData: true });
+	const eager = isolate.compileScriptSync(code, { produceCachedData: true, eager: true });
+	const streamed = await new ivm.Isolate().compileScript(code, { produceCachedData: true, eager: true });
+	assert.ok(eager.cachedData.copy().byteLength > lazy.cachedData.copy().byteLength * 2);
+	assert.ok(streamed.cachedData.copy().byteLength > lazy.cachedData.copy().byteLength * 2);
+	assert.strictEqual(eager.runSync(context), 30);
+
+	// Eager cached data can be consumed
+	const consumed = await isolate.compileScript(code, { cachedData: eager.cachedData, eager: true });
+	assert.strictEqual(consumed.cachedDataRejected, false);
+	assert.strictEqual(await consumed.run(context), 30);
+
+	// Modules
+	const module = await isolate.compileModule('export default (() => 1)();', { eager: true });
+	await module.instantiate(context, () => { throw new Error; });
+	await module.evaluate();
+	assert.strictEqual(await module.namespace.get('default'), 1);
+	console.log('pass');
+})().catch(console.error);
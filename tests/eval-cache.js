@@ -0,0 +1,56 @@
+'use strict';
+const ivm = require('isolated-vm');
+const assert = require('assert');
+
+const isolate = new ivm.Isolate({ evalCacheSize: 2 });
+const plain = new ivm.Isolate;
+const context = isolate.createContextSync();
+const stats = () => {
+	const { evalCacheHits, evalCacheMisses } = isolate.getStatsSnapshot();
+	return [ evalCacheHits, evalCacheMisses ];
+};
+
+// Repeated closures with different arguments
+for (let ii = 0; ii < 5; ++ii) {
+	assert.strictEqual(context.evalClosureSync('return $0 + $1', [ ii, 1 ]), ii + 1);
+}
+assert.deepStrictEqual(stats(), [ 4, 1 ]);
+
+// Compiled code is shared between contexts, but runs against each context's globals
+const other = isolate.createContextSync();
+context.evalSync('globalThis.name = "first"');
+other.evalSync('globalThis.name = "second"');
+assert.strictEqual(context.evalClosureSync('return name + $0', [ 1 ]), 'first1');
+assert.strictEqual(other.evalClosureSync('return name + $0', [ 1 ]), 'second1');
+assert.deepStrictEqual(stats(), [ 5, 4 ]);
+
+// Origin is part of the key, and the least recently used entry is evicted
+context.evalSync('1', { filename: 'a.js' });
+context.evalSync('1', { filename: 'b.js' });
+context.evalSync('1', { filename: 'a.js' });
+context.evalSync('1', { filename: 'c.js' });
+context.evalSync('1', { filename: 'b.js' });
+assert.deepStrictEqual(stats(), [ 6, 8 ]);
+
+// Errors and stack traces point at the same place with and without the cache
+const check = (code, options) => {
+	const error = fn => { try { fn(); } catch (error) { return error; } };
+	for (let ii = 0; ii < 2; ++ii) {
+		const cached = error(() => context.evalClosureSync(code, [ 1 ], options));
+		const uncached = error(() => plain.createContextSync().evalClosureSync(code, [ 1 ], options));
+		assert.strictEqual(cached.message, uncached.message);
+		assert.strictEqual(cached.stack.split('\n')[1], uncached.stack.split('\n')[1]);
+	}
+};
+check('throw new Error($0)', { filename: 'one.js', columnOffset: 4 });
+check('\n  return (() => { throw new Error("inner") })()', { filename: 'two.js', lineOffset: 10 });
+check('return 1 +', { filename: 'three.js' });
+for (let ii = 0; ii < 2; ++ii) {
+	assert.strictEqual(context.evalClosureSync('return $0 // trailing comment', [ 1 ]), 1);
+}
+
+// Disabled by default
+plain.createContextSync().evalClosureSync('return 1');
+assert.strictEqual(plain.getStatsSnapshot().evalCacheMisses, 0);
+assert.throws(() => new ivm.Isolate({ evalCacheSize: -1 }), /evalCacheSize/);
+console.log('pass');
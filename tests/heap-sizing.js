@@ -0,0 +1,43 @@
+'use strict';
+const ivm = require('isolated-vm');
+const assert = require('assert');
+
+// Runs `code` in a new isolate, returning the heap size right after creation and the used heap size
+// once the code has finished
+function run(options, code = 'globalThis.data = Array(1024 * 64).fill().map((_, ii) => ({ ii })); data.length') {
+	const isolate = new ivm.Isolate(options);
+	const context = isolate.createContextSync();
+	const initial = isolate.getHeapStatisticsSync().total_heap_size;
+	context.evalSync(code);
+	const used = isolate.getHeapStatisticsSync().used_heap_size;
+	isolate.dispose();
+	return { initial, used };
+}
+
+// Validation
+assert.throws(() => new ivm.Isolate({ memoryLimit: 16, initialOldGenerationSize: 32 }), RangeError);
+assert.throws(() => new ivm.Isolate({ initialYoungGenerationSize: -1 }), RangeError);
+
+// An explicit old generation size moves the first full collection. 60mb of garbage fits under the
+// default, but not under 8mb.
+const garbage = 'for (let ii = 0; ii < 60; ++ii) new Array(128 * 1024).fill(ii);';
+const mb = 1024 * 1024;
+assert.ok(run({ memoryLimit: 128 }, garbage).used > 55 * mb);
+assert.ok(run({ memoryLimit: 128, initialOldGenerationSize: 8 }, garbage).used < 55 * mb);
+
+// An explicit young generation size changes the heap the isolate starts with
+const plain = run({ memoryLimit: 128 }).initial;
+const sized = run({ memoryLimit: 128, initialYoungGenerationSize: 4 }).initial;
+assert.notStrictEqual(sized, plain);
+
+// Workload profile is recorded by the first isolate and used to size the rest
+const workload = 'globalThis.data = Array(1024 * 256).fill().map((_, ii) => ({ ii })); for (let ii = 0; ii < 1e6; ++ii) ({ ii });';
+assert.strictEqual(run({ memoryLimit: 128, workload: 'heap-sizing' }, workload).initial, plain);
+for (let ii = 0; ii < 3; ++ii) {
+	assert.strictEqual(run({ memoryLimit: 128, workload: 'heap-sizing' }, workload).initial, sized);
+}
+
+// Explicit sizes override the recorded profile
+assert.strictEqual(run({ memoryLimit: 128, workload: 'heap-sizing', initialYoungGenerationSize: 1 }).initial,
+	run({ memoryLimit: 128, initialYoungGenerationSize: 1 }).initial);
+console.log('pass');
@@ -0,0 +1,53 @@
+'use strict';
+const ivm = require('isolated-vm');
+const assert = require('assert');
+
+const snapshot = ivm.Isolate.createSnapshot([ { code: 'globalThis.greeting = "hello"' } ]);
+
+(async function() {
+	const isolate = new ivm.Isolate({ snapshot, memoryLimit: 32 });
+
+	// Can't hibernate while something still points into the heap
+	let context = await isolate.createContext();
+	await context.eval('globalThis.scratch = 1');
+	await assert.rejects(isolate.hibernate(), /outstanding references/);
+	assert.strictEqual(isolate.isHibernating, false);
+	context.release();
+
+	await isolate.hibernate();
+	assert.strictEqual(isolate.isHibernating, true);
+	assert.strictEqual(isolate.isDisposed, false);
+	assert.strictEqual(isolate.referenceCount, 0);
+	assert.throws(() => isolate.hibernateSync(), /already hibernating/);
+
+	// Read-only accessors don't wake it up
+	assert.strictEqual(typeof isolate.cpuTime, 'bigint');
+	assert.strictEqual(typeof isolate.wallTime, 'bigint');
+	assert.ok(isolate.getStatsSnapshot().timestamp > 0);
+	const heap = await isolate.getHeapStatistics();
+	assert.strictEqual(heap.used_heap_size, 0);
+	assert.ok(heap.heap_size_limit > 0);
+	assert.strictEqual(isolate.getHeapStatisticsSync().used_heap_size, 0);
+	assert.strictEqual(isolate.isHibernating, true);
+
+	// Using the isolate again rebuilds it from the snapshot
+	context = isolate.createContextSync();
+	assert.strictEqual(isolate.isHibernating, false);
+	assert.strictEqual(context.evalSync('greeting'), 'hello');
+	assert.strictEqual(context.evalSync('typeof scratch'), 'undefined');
+	context.release();
+	isolate.hibernateSync();
+	assert.strictEqual(isolate.isHibernating, true);
+
+	// The memory limit carries over
+	context = await isolate.createContext();
+	await assert.rejects(context.eval('const a = []; for (;;) a.push(new Array(1e6).fill(1))'), /memory limit/);
+
+	// Disposal while hibernating
+	const other = new ivm.Isolate({ snapshot });
+	await other.hibernate();
+	await other.dispose();
+	assert.strictEqual(other.isDisposed, true);
+	assert.strictEqual(other.isHibernating, false);
+	console.log('pass');
+})().catch(console.error);
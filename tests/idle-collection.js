@@ -0,0 +1,20 @@
+'use strict';
+const ivm = require('isolated-vm');
+const assert = require('assert');
+
+const isolate = new ivm.Isolate({ memoryLimit: 128, idleCollectionDelay: 20 });
+const context = isolate.createContextSync();
+context.evalSync(`
+	globalThis.garbage = Array(1024 * 128).fill().map(() => ({}));
+	delete globalThis.garbage;
+`);
+const before = isolate.getHeapStatisticsSync().used_heap_size;
+
+// Garbage should be collected once the isolate has been idle for a while, without any allocation
+// pressure from inside the isolate
+setTimeout(() => {
+	const after = isolate.getHeapStatisticsSync().used_heap_size;
+	assert.ok(after < before, `${after} < ${before}`);
+	assert.strictEqual(context.evalSync('1 + 1'), 2);
+	console.log('pass');
+}, 500);
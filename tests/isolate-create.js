@@ -0,0 +1,32 @@
+'use strict';
+const ivm = require('isolated-vm');
+const assert = require('assert');
+
+(async function() {
+	const snapshot = ivm.Isolate.createSnapshot([ { code: 'globalThis.value = 123' } ]);
+
+	// Many isolates can be built at once
+	const isolates = await Promise.all(Array(8).fill().map(() => ivm.Isolate.create({ memoryLimit: 32, snapshot })));
+	for (const isolate of isolates) {
+		assert.ok(isolate instanceof ivm.Isolate);
+		const context = await isolate.createContext();
+		assert.strictEqual(await context.eval('value'), 123);
+		isolate.dispose();
+	}
+
+	// Options are validated up front
+	assert.throws(() => ivm.Isolate.create({ memoryLimit: 1 }));
+
+	// Options which are applied after construction still work
+	const group = new ivm.IsolateGroup({ memoryLimit: 16 });
+	await assert.rejects(ivm.Isolate.create({ group, memoryFloor: 32, memoryLimit: 64 }), RangeError);
+	const isolate = await ivm.Isolate.create({ group, memoryFloor: 8, memoryLimit: 16 });
+	assert.ok(group.memoryUsage >= 8 * 1024 * 1024);
+	isolate.dispose();
+
+	// A pending create keeps the process alive
+	ivm.Isolate.create().then(isolate => {
+		isolate.dispose();
+		console.log('pass');
+	});
+})().catch(console.error);
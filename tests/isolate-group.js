@@ -0,0 +1,32 @@
+'use strict';
+const ivm = require('isolated-vm');
+const assert = require('assert');
+
+const group = new ivm.IsolateGroup({ memoryLimit: 48 });
+assert.strictEqual(group.memoryLimit, 48 * 1024 * 1024);
+
+// Floors are reserved up front
+const isolates = [ 1, 2, 3 ].map(() => new ivm.Isolate({ memoryLimit: 64, group, memoryFloor: 12 }));
+assert.ok(group.memoryUsage >= 36 * 1024 * 1024);
+assert.throws(() => new ivm.Isolate({ memoryLimit: 64, group, memoryFloor: 16 }), /budget/);
+
+// One isolate can grow past its floor into the shared budget, but not past the group limit
+const contexts = isolates.map(isolate => isolate.createContextSync());
+const grow = context => context.evalSync(`
+	const storage = [];
+	for (let ii = 0; ii < 40; ++ii) {
+		storage.push(Array(1024 * 64).fill().map(() => ({})));
+	}
+`);
+assert.throws(() => grow(contexts[0]), /memory limit/);
+assert.ok(isolates[0].isDisposed);
+assert.strictEqual(contexts[1].evalSync('1 + 1'), 2);
+
+// Disposed members give their budget back
+(async function() {
+	const usage = group.memoryUsage;
+	await isolates[1].dispose();
+	assert.ok(group.memoryUsage < usage);
+	new ivm.Isolate({ memoryLimit: 64, group, memoryFloor: 16 });
+	console.log('pass');
+})().catch(console.error);
@@ -0,0 +1,51 @@
+'use strict';
+const ivm = require('isolated-vm');
+const assert = require('assert');
+
+const snapshot = ivm.Isolate.createSnapshot([ { code: 'globalThis.value = 123' } ]);
+const pool = new ivm.IsolatePool({ size: 2, isolate: { memoryLimit: 32, snapshot } });
+assert.strictEqual(pool.size, 2);
+
+function waitForPool(count) {
+	return new Promise(resolve => {
+		const check = () => pool.available >= count ? resolve() : setTimeout(check, 5);
+		check();
+	});
+}
+
+(async function() {
+	await waitForPool(2);
+
+	// Pooled isolates are usable and were built from the snapshot
+	const isolate = pool.acquire();
+	assert.ok(isolate instanceof ivm.Isolate);
+	const context = isolate.createContextSync();
+	assert.strictEqual(context.evalSync('value'), 123);
+	assert.strictEqual(pool.hits, 1);
+
+	// Back-to-back acquires may drain the pool, in which case isolates are built inline
+	await waitForPool(2);
+	const drained = [ pool.acquire(), pool.acquire(), pool.acquire() ];
+	assert.ok(pool.hits >= 3);
+	assert.strictEqual(pool.hits + pool.misses, 4);
+	drained.forEach(isolate => isolate.dispose());
+
+	// An empty pool always builds inline
+	const empty = new ivm.IsolatePool({ size: 0 });
+	empty.acquire().dispose();
+	assert.strictEqual(empty.hits, 0);
+	assert.strictEqual(empty.misses, 1);
+
+	// Refills in the background
+	await waitForPool(2);
+	assert.strictEqual(pool.available, 2);
+
+	pool.dispose();
+	assert.strictEqual(pool.available, 0);
+	assert.throws(() => pool.acquire());
+	isolate.dispose();
+
+	// Abandoned pools with isolates still being built shouldn't get in the way of shutdown
+	new ivm.IsolatePool({ size: 4 });
+	console.log('pass');
+})().catch(console.error);
@@ -0,0 +1,38 @@
+'use strict';
+const ivm = require('isolated-vm');
+const assert = require('assert');
+
+const isolate = new ivm.Isolate({ lazyDefaultContext: true });
+const nativeContexts = isolate => isolate.getHeapStatisticsSync().number_of_native_contexts;
+
+// Contexts work without the default context, and using them doesn't build it
+assert.strictEqual(nativeContexts(isolate), 0);
+const context = isolate.createContextSync();
+assert.strictEqual(context.evalSync('1 + 1'), 2);
+context.global.setSync('copied', { a: 1 }, { copy: true });
+assert.deepStrictEqual(context.global.getSync('copied', { copy: true }), { a: 1 });
+
+// Errors thrown from a context are still copied out, which does need it
+assert.strictEqual(nativeContexts(isolate), 1);
+assert.throws(() => context.evalSync('throw new TypeError("oops")'), /oops/);
+assert.strictEqual(nativeContexts(isolate), 2);
+
+// Isolates without the option build it up front
+const eager = new ivm.Isolate;
+assert.strictEqual(nativeContexts(eager), 1);
+
+// Compiling builds the default context on demand
+const compiler = new ivm.Isolate({ lazyDefaultContext: true });
+compiler.compileScriptSync('1');
+assert.strictEqual(nativeContexts(compiler), 1);
+const script = isolate.compileScriptSync('globalThis.value = 3');
+script.runSync(context);
+assert.strictEqual(context.evalSync('value'), 3);
+
+(async function() {
+	const other = new ivm.Isolate({ lazyDefaultContext: true });
+	await assert.rejects(other.compileScript('*'), SyntaxError);
+	const context = await other.createContext();
+	await assert.rejects(context.eval('Promise.reject(new Error("async"))', { promise: true }), /async/);
+	console.log('pass');
+})().catch(console.error);
@@ -0,0 +1,36 @@
+// Measures how isolate creation and disposal scale with the number of threads doing it. Each
+// worker builds, uses, and disposes isolates in a loop; the total rate should grow roughly with the
+// number of cores.
+'use strict';
+const os = require('os');
+const { Worker, isMainThread, parentPort, workerData } = require('worker_threads');
+const ivm = require('isolated-vm');
+
+const kIsolatesPerThread = 100;
+
+if (isMainThread) {
+	(async function() {
+		const cores = os.availableParallelism();
+		for (let threads = 1; threads <= cores; threads *= 2) {
+			const start = process.hrtime.bigint();
+			await Promise.all(Array(threads).fill().map(() => new Promise((resolve, reject) => {
+				const worker = new Worker(__filename, { workerData: kIsolatesPerThread });
+				worker.on('message', resolve);
+				worker.on('error', reject);
+			})));
+			const seconds = Number(process.hrtime.bigint() - start) / 1e9;
+			const rate = Math.round(threads * kIsolatesPerThread / seconds);
+			console.log(`${threads} thread(s): ${rate} isolates/s`);
+		}
+	})().catch(console.error);
+} else {
+	(async function() {
+		for (let ii = 0; ii < workerData; ++ii) {
+			const isolate = new ivm.Isolate({ memoryLimit: 32 });
+			const context = isolate.createContextSync();
+			context.evalSync('1 + 1');
+			await isolate.dispose();
+		}
+		parentPort.postMessage(null);
+	})().catch(console.error);
+}
@@ -0,0 +1,42 @@
+// Measures resident memory per idle isolate. Run with `--expose-gc` for steadier numbers. Each
+// configuration builds a batch of isolates, waits for them to settle, and reports the growth in
+// RSS divided by the number of isolates.
+'use strict';
+const ivm = require('isolated-vm');
+
+const kIsolates = 200;
+
+const configurations = {
+	'default': {},
+	'lazyDefaultContext': { lazyDefaultContext: true },
+	'lazyDefaultContext + 1 context': { lazyDefaultContext: true, context: true },
+	'default + 1 context': { context: true },
+};
+
+async function measure(options) {
+	global.gc?.();
+	const before = process.memoryUsage().rss;
+	const isolates = [];
+	const contexts = [];
+	for (let ii = 0; ii < kIsolates; ++ii) {
+		const isolate = new ivm.Isolate({ memoryLimit: 16, lazyDefaultContext: options.lazyDefaultContext });
+		if (options.context) {
+			contexts.push(await isolate.createContext());
+		}
+		isolates.push(isolate);
+	}
+	await new Promise(resolve => setTimeout(resolve, 100));
+	global.gc?.();
+	const perIsolate = (process.memoryUsage().rss - before) / kIsolates;
+	await Promise.all(isolates.map(isolate => isolate.dispose()));
+	return perIsolate;
+}
+
+(async function() {
+	// The first batch pays for one-time allocations in the process
+	await measure({});
+	for (const [ name, options ] of Object.entries(configurations)) {
+		const bytes = await measure(options);
+		console.log(`${name}: ${(bytes / 1024).toFixed(0)} KiB per isolate`);
+	}
+})().catch(console.error);
@@ -0,0 +1,31 @@
+'use strict';
+const ivm = require('isolated-vm');
+const assert = require('assert');
+
+const isolate = new ivm.Isolate({ memoryLimit: 128 });
+const context = isolate.createContextSync();
+const makeGarbage = () => context.evalSync(`
+	globalThis.garbage = Array(1024 * 64).fill().map(() => ({}));
+	delete globalThis.garbage;
+`);
+const used = () => isolate.getHeapStatisticsSync().used_heap_size;
+
+assert.throws(() => ivm.setMemoryGovernor({}));
+makeGarbage();
+const before = used();
+
+// Any process will be over these thresholds, so the governor will immediately broadcast pressure
+ivm.setMemoryGovernor({ moderate: 1, critical: 2, interval: 10 });
+setTimeout(() => {
+	ivm.setMemoryGovernor();
+	assert.ok(used() < before);
+
+	// Explicit trim
+	makeGarbage();
+	const before2 = used();
+	ivm.trimMemory();
+	setTimeout(() => {
+		assert.ok(used() < before2);
+		console.log('pass');
+	}, 100);
+}, 100);
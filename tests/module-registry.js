@@ -0,0 +1,58 @@
+'use strict';
+const ivm = require('isolated-vm');
+const assert = require('assert');
+
+(async function() {
+	const isolate = new ivm.Isolate;
+	const context = await isolate.createContext();
+
+	// A graph instantiated without a resolve callback
+	await isolate.compileModule('export const a = 1;', { specifier: 'a' });
+	await isolate.compileModule('import { a } from "a"; export const b = a + 1;', { specifier: 'b' });
+	const root = await isolate.compileModule('import { a } from "a"; import { b } from "b"; export default a + b;');
+	await root.instantiate(context);
+	await root.evaluate();
+	assert.strictEqual(await root.namespace.get('default', { copy: true }), 3);
+
+	// Missing registrations fail to instantiate
+	const missing = isolate.compileModuleSync('import "nope";');
+	assert.throws(() => missing.instantiateSync(context), /Cannot find module 'nope'/);
+
+	// A resolve callback still takes precedence
+	const override = isolate.compileModuleSync('export const a = 10;');
+	const linked = isolate.compileModuleSync('import { a } from "a"; export default a;');
+	linked.instantiateSync(context, () => override);
+	linked.evaluateSync();
+	assert.strictEqual(linked.namespace.getSync('default'), 10);
+
+	// Dynamic import
+	isolate.compileModuleSync('export const value = "dynamic";', { specifier: 'dyn' });
+	assert.strictEqual(await context.eval('import("dyn").then(ns => ns.value)', { promise: true }), 'dynamic');
+	assert.strictEqual(await context.eval('import("b").then(ns => ns.b)', { promise: true }), 2);
+	await assert.rejects(context.eval('import("nope")', { promise: true }), /Cannot find module 'nope'/);
+
+	// Errors thrown during evaluation reject the import
+	isolate.compileModuleSync('throw new Error("boom");', { specifier: 'throws' });
+	await assert.rejects(context.eval('import("throws")', { promise: true }), /boom/);
+
+	// Registering again replaces the module, and unregistering removes it
+	isolate.compileModuleSync('export const value = "replaced";', { specifier: 'dyn' });
+	assert.strictEqual(await context.eval('import("dyn").then(ns => ns.value)', { promise: true }), 'replaced');
+	for (const specifier of [ 'a', 'b', 'dyn', 'throws' ]) {
+		assert.strictEqual(await isolate.unregisterModule(specifier), true);
+	}
+	assert.strictEqual(isolate.unregisterModuleSync('a'), false);
+	assert.throws(() => isolate.compileModuleSync('import "a";').instantiateSync(context), /Cannot find module 'a'/);
+
+	// Registered modules keep an isolate from hibernating until they're gone
+	const sleepy = new ivm.Isolate;
+	sleepy.compileModuleSync('export default 1;', { specifier: 'm' }).release();
+	assert.throws(() => sleepy.hibernateSync(), /registered modules/);
+	sleepy.unregisterModuleSync('m');
+	sleepy.hibernateSync();
+	assert.strictEqual(sleepy.isHibernating, true);
+
+	// Registered modules are cleaned up on dispose
+	isolate.dispose();
+	console.log('pass');
+})().catch(console.error);
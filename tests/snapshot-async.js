@@ -0,0 +1,57 @@
+'use strict';
+const ivm = require('isolated-vm');
+const assert = require('assert');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+
+(async function() {
+	const scripts = [ { code: 'function greet() { return "hello " + "x".repeat(2048).length; }' } ];
+
+	// Built off-thread, usable like a sync snapshot
+	const snapshot = await ivm.Isolate.createSnapshotAsync(scripts);
+	const isolate = new ivm.Isolate({ snapshot });
+	assert.strictEqual(isolate.createContextSync().evalSync('greet()'), 'hello 2048');
+
+	// Errors reject the promise
+	await assert.rejects(ivm.Isolate.createSnapshotAsync([ { code: 'throw new Error("nope")' } ]), /nope/);
+
+	// Identical requests share one build
+	const cached = await Promise.all([ 1, 2 ].map(() => ivm.Isolate.createSnapshotAsync(scripts, undefined, { cache: true })));
+	const again = ivm.Isolate.createSnapshot(scripts, undefined, { cache: true });
+	assert.deepStrictEqual(Buffer.from(again.copy()), Buffer.from(cached[0].copy()));
+	assert.deepStrictEqual(Buffer.from(cached[1].copy()), Buffer.from(cached[0].copy()));
+
+	// Writing to a transferred snapshot doesn't touch the cached one
+	const expected = Buffer.from(again.copy());
+	new Uint8Array(cached[0].copy({ transferIn: true })).fill(0);
+	const unchanged = ivm.Isolate.createSnapshot(scripts, undefined, { cache: true });
+	assert.deepStrictEqual(Buffer.from(unchanged.copy()), expected);
+	assert.strictEqual(new ivm.Isolate({ snapshot: unchanged }).createContextSync().evalSync('greet()'), 'hello 2048');
+
+	// Snapshots are saved to disk by content hash
+	const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'ivm-snapshot-'));
+	try {
+		const first = await ivm.Isolate.createSnapshotAsync(scripts, 'greet()', { cacheDirectory: dir });
+		const files = fs.readdirSync(dir);
+		assert.strictEqual(files.length, 1);
+		assert.ok(/\.snapshot$/.test(files[0]));
+		const second = ivm.Isolate.createSnapshot(scripts, 'greet()', { cacheDirectory: dir });
+		assert.deepStrictEqual(Buffer.from(second.copy()), Buffer.from(first.copy()));
+		await ivm.Isolate.createSnapshotAsync(scripts, 'greet() + 1', { cacheDirectory: dir });
+		assert.strictEqual(fs.readdirSync(dir).length, 2);
+
+		// Damaged files are rebuilt instead of being handed to v8
+		const file = path.join(dir, files[0]);
+		const contents = fs.readFileSync(file);
+		for (const damaged of [ contents.subarray(0, contents.length >> 1), Buffer.from(contents).fill(1, 64, 128) ]) {
+			fs.writeFileSync(file, damaged);
+			const rebuilt = ivm.Isolate.createSnapshot(scripts, 'greet()', { cacheDirectory: dir });
+			assert.strictEqual(new ivm.Isolate({ snapshot: rebuilt }).createContextSync().evalSync('greet()'), 'hello 2048');
+			assert.deepStrictEqual(fs.readFileSync(file), contents);
+		}
+	} finally {
+		fs.rmSync(dir, { recursive: true });
+	}
+	console.log('pass');
+})().catch(console.error);
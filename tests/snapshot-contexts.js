@@ -0,0 +1,36 @@
+'use strict';
+const ivm = require('isolated-vm');
+const assert = require('assert');
+
+const snapshot = ivm.Isolate.createSnapshot([ { code: 'globalThis.kind = "default"' } ], undefined, {
+	contexts: [
+		[ { code: 'globalThis.kind = "first"' }, { code: 'globalThis.counter = 0; function next() { return ++counter; }' } ],
+		[ { code: 'globalThis.kind = "second"' } ],
+	],
+});
+const isolate = new ivm.Isolate({ snapshot });
+
+// Default contexts are unaffected
+assert.strictEqual(isolate.createContextSync().evalSync('kind'), 'default');
+
+// Each restored context is independent and already set up
+const first = isolate.createContextSync({ snapshotIndex: 0 });
+const again = isolate.createContextSync({ snapshotIndex: 0 });
+assert.strictEqual(first.evalSync('kind'), 'first');
+assert.strictEqual(first.evalSync('next(), next()'), 2);
+assert.strictEqual(again.evalSync('next()'), 1);
+assert.strictEqual(isolate.createContextSync({ snapshotIndex: 1 }).evalSync('kind'), 'second');
+
+// Out of range indices
+assert.throws(() => isolate.createContextSync({ snapshotIndex: 2 }), /out of range/);
+assert.throws(() => new ivm.Isolate().createContextSync({ snapshotIndex: 0 }), /out of range/);
+assert.throws(() => isolate.createContextSync({ snapshotIndex: 1.5 }), /non-negative integer/);
+for (const snapshotIndex of [ -1, -2, NaN, Infinity ]) {
+	assert.throws(() => isolate.createContextSync({ snapshotIndex }), RangeError);
+}
+
+(async function() {
+	const context = await isolate.createContext({ snapshotIndex: 1 });
+	assert.strictEqual(await context.eval('kind'), 'second');
+	console.log('pass');
+})().catch(console.error);
@@ -0,0 +1,30 @@
+'use strict';
+const ivm = require('isolated-vm');
+const assert = require('assert');
+
+let notified = 0;
+const isolate = new ivm.Isolate({
+	memoryLimit: 64,
+	softMemoryLimit: 16,
+	onSoftMemoryLimit: bytes => {
+		assert.ok(bytes > 16 * 1024 * 1024);
+		++notified;
+	},
+});
+assert.throws(() => new ivm.Isolate({ memoryLimit: 16, softMemoryLimit: 16 }));
+
+const context = isolate.createContextSync();
+context.evalSync(`
+	const storage = [];
+	for (let ii = 0; ii < 12; ++ii) {
+		storage.push(Array(1024 * 64).fill().map(() => ({})));
+	}
+`);
+
+setTimeout(() => {
+	// Isolate keeps running after crossing the soft limit
+	assert.strictEqual(context.evalSync('storage.length'), 12);
+	assert.strictEqual(isolate.isDisposed, false);
+	assert.strictEqual(notified, 1);
+	console.log('pass');
+}, 100);
@@ -0,0 +1,31 @@
+'use strict';
+const ivm = require('isolated-vm');
+const assert = require('assert');
+
+const isolate = new ivm.Isolate({ memoryLimit: 128 });
+const initial = isolate.getStatsSnapshot();
+assert.ok(initial.used_heap_size > 0);
+assert.strictEqual(typeof initial.cpuTime, 'bigint');
+assert.strictEqual(initial.queueDepth, 0);
+
+const context = isolate.createContextSync();
+context.evalSync('globalThis.data = Array(1024 * 64).fill().map(() => ({}))');
+const afterSync = isolate.getStatsSnapshot();
+assert.ok(afterSync.used_heap_size > initial.used_heap_size);
+assert.ok(afterSync.cpuTime > initial.cpuTime);
+assert.ok(afterSync.timestamp >= initial.timestamp);
+
+// Snapshot can be read while the isolate is busy, and reflects queued work
+const busy = context.eval('const t = Date.now(); while (Date.now() < t + 200);');
+const queued = [ 1, 2, 3 ].map(() => context.eval('1'));
+const during = Date.now();
+const snapshot = isolate.getStatsSnapshot();
+assert.ok(Date.now() - during < 50);
+assert.ok(snapshot.heap_size_limit > 0);
+
+Promise.all([ busy, ...queued ]).then(() => {
+	assert.ok(isolate.getStatsSnapshot().wallTime >= snapshot.wallTime);
+	isolate.dispose();
+	assert.throws(() => isolate.getStatsSnapshot());
+	console.log('pass');
+}).catch(console.error);
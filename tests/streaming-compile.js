@@ -0,0 +1,41 @@
+'use strict';
+const ivm = require('isolated-vm');
+const assert = require('assert');
+
+const body = Array.from({ length: 2e4 }, (_, ii) => `function fn${ii}() { return ${ii}; }`).join('\n');
+
+(async function() {
+	const isolate = new ivm.Isolate;
+	const context = await isolate.createContext();
+
+	// Scripts, including two-byte source
+	const script = await isolate.compileScript(`${body}\nfn19999() + '☃'`, { filename: 'big.js' });
+	assert.strictEqual(await script.run(context), '19999☃');
+
+	// Errors are still annotated
+	await assert.rejects(isolate.compileScript('\n  )', { filename: 'bad.js' }), /\[bad\.js:2:3\]/);
+
+	// Cached data from a streamed compile can be consumed
+	const produced = await isolate.compileScript(body, { produceCachedData: true });
+	assert.ok(produced.cachedData instanceof ivm.ExternalCopy);
+	const consumed = await isolate.compileScript(body, { cachedData: produced.cachedData });
+	assert.strictEqual(consumed.cachedDataRejected, false);
+
+	// Modules
+	const module = await isolate.compileModule(`${body}\nexport default fn123();`);
+	await module.instantiate(context, () => { throw new Error; });
+	await module.evaluate();
+	assert.strictEqual(await module.namespace.get('default', { copy: true }), 123);
+	await assert.rejects(isolate.compileModule('export let'), /SyntaxError/);
+
+	// Many at once
+	const scripts = await Promise.all(Array.from({ length: 16 }, (_, ii) => isolate.compileScript(`${body}\nfn${ii}()`)));
+	assert.deepStrictEqual(await Promise.all(scripts.map(script => script.run(context))), Array.from({ length: 16 }, (_, ii) => ii));
+
+	// Disposing while compiling either finishes or rejects cleanly
+	const other = new ivm.Isolate;
+	const pending = other.compileScript(body);
+	other.dispose();
+	await pending.catch(error => assert.match(error.message, /disposed/));
+	console.log('pass');
+})().catch(console.error);
@@ -0,0 +1,55 @@
+'use strict';
+const ivm = require('isolated-vm');
+const assert = require('assert');
+
+// (module (func (export "foo") (result i32) i32.const 123))
+const bytes = new Uint8Array([
+	0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00,
+	0x01, 0x05, 0x01, 0x60, 0x00, 0x01, 0x7f,
+	0x03, 0x02, 0x01, 0x00,
+	0x07, 0x07, 0x01, 0x03, 0x66, 0x6f, 0x6f, 0x00, 0x00,
+	0x0a, 0x07, 0x01, 0x05, 0x00, 0x41, 0xfb, 0x00, 0x0b,
+]);
+
+function setup() {
+	const isolate = new ivm.Isolate;
+	const context = isolate.createContextSync();
+	context.global.setSync('bytes', new ivm.ExternalCopy(bytes).copyInto());
+	return context;
+}
+
+(async function() {
+	// Disabled by default
+	setup().evalSync('new WebAssembly.Module(bytes)');
+	assert.deepStrictEqual(ivm.getWasmCacheStatistics(), { entries: 0, maxEntries: 0, hits: 0, misses: 0 });
+
+	ivm.setWasmCache({ maxEntries: 2 });
+
+	// The first isolate compiles, the next ones hit
+	assert.strictEqual(setup().evalSync('new WebAssembly.Instance(new WebAssembly.Module(bytes)).exports.foo()'), 123);
+	assert.strictEqual(setup().evalSync('new WebAssembly.Instance(new WebAssembly.Module(bytes.buffer)).exports.foo()'), 123);
+	assert.strictEqual(await setup().eval('WebAssembly.compile(bytes).then(module => new WebAssembly.Instance(module).exports.foo())', { promise: true }), 123);
+	assert.deepStrictEqual(ivm.getWasmCacheStatistics(), { entries: 1, maxEntries: 2, hits: 2, misses: 1 });
+
+	// Different bytes are a different entry
+	const other = bytes.slice();
+	other.set([ 0x7b, 0x01 ], other.length - 3); // i32.const -5; nop
+	const context = setup();
+	context.global.setSync('other', new ivm.ExternalCopy(other).copyInto());
+	assert.strictEqual(context.evalSync('new WebAssembly.Instance(new WebAssembly.Module(other)).exports.foo()'), -5);
+	assert.strictEqual(await context.eval('WebAssembly.compile(other).then(module => new WebAssembly.Instance(module).exports.foo())', { promise: true }), -5);
+	assert.deepStrictEqual(ivm.getWasmCacheStatistics(), { entries: 2, maxEntries: 2, hits: 3, misses: 2 });
+
+	// Errors are still thrown
+	assert.throws(() => context.evalSync('new WebAssembly.Module(new Uint8Array([ 1, 2, 3 ]))'), /CompileError/);
+	await assert.rejects(context.eval('WebAssembly.compile(123)', { promise: true }), /TypeError/);
+	assert.strictEqual(context.evalSync('WebAssembly.compile.name'), 'compile');
+
+	// Shrinking evicts
+	ivm.setWasmCache({ maxEntries: 1 });
+	assert.strictEqual(ivm.getWasmCacheStatistics().entries, 1);
+	ivm.setWasmCache();
+	assert.strictEqual(ivm.getWasmCacheStatistics().entries, 0);
+	assert.throws(() => ivm.setWasmCache({ maxEntries: -1 }), /must not be negative/);
+	console.log('pass');
+})().catch(console.error);
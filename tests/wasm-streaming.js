@@ -0,0 +1,68 @@
+'use strict';
+const ivm = require('isolated-vm');
+const assert = require('assert');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+
+// (module (func (export "foo") (result i32) i32.const 123))
+const bytes = new Uint8Array([
+	0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00,
+	0x01, 0x05, 0x01, 0x60, 0x00, 0x01, 0x7f,
+	0x03, 0x02, 0x01, 0x00,
+	0x07, 0x07, 0x01, 0x03, 0x66, 0x6f, 0x6f, 0x00, 0x00,
+	0x0a, 0x07, 0x01, 0x05, 0x00, 0x41, 0xfb, 0x00, 0x0b,
+]);
+
+// Same module with a 3mb custom section in front so it arrives over several chunks
+const padding = 3 * 1024 * 1024;
+const big = Buffer.concat([
+	bytes.subarray(0, 8),
+	Buffer.from([ 0x00, 0x82, 0x80, 0xc0, 0x81, 0x00, 0x01, 0x78 ]), // custom section "x", 3mb + 2 bytes
+	Buffer.alloc(padding),
+	bytes.subarray(8),
+]);
+const bigCopy = new ivm.ExternalCopy(big.buffer.slice(big.byteOffset, big.byteOffset + big.length));
+
+function run(module) {
+	const isolate = new ivm.Isolate;
+	const context = isolate.createContextSync();
+	context.global.setSync('module', module.copyInto());
+	return context.evalSync('new WebAssembly.Instance(module).exports.foo()');
+}
+
+(async function() {
+	const isolate = new ivm.Isolate;
+
+	// From an ExternalCopy, into other isolates
+	const module = await isolate.compileWasm(new ivm.ExternalCopy(bytes.buffer));
+	assert.ok(module instanceof ivm.ExternalCopy);
+	assert.strictEqual(run(module), 123);
+	assert.strictEqual(run(module), 123);
+
+	// From a file
+	const file = path.join(os.tmpdir(), `ivm-wasm-streaming-${process.pid}.wasm`);
+	fs.writeFileSync(file, big);
+	try {
+		assert.strictEqual(run(await isolate.compileWasm(file)), 123);
+		assert.strictEqual(run(await isolate.compileWasm(bigCopy)), 123);
+	} finally {
+		fs.unlinkSync(file);
+	}
+
+	// Errors
+	await assert.rejects(isolate.compileWasm(new ivm.ExternalCopy(new Uint8Array([ 1, 2, 3 ]).buffer)), /CompileError/);
+	await assert.rejects(isolate.compileWasm(file), /Failed to open/);
+	await assert.rejects(isolate.compileWasm({}), /must be a filename or an ExternalCopy/);
+
+	// Disposing while compiling either finishes or rejects cleanly
+	const other = new ivm.Isolate;
+	const pending = other.compileWasm(bigCopy);
+	other.dispose();
+	await pending.catch(error => assert.match(error.message, /disposed/));
+
+	// Isolated code doesn't get `compileStreaming()`
+	const context = await isolate.createContext();
+	assert.strictEqual(context.evalSync('typeof WebAssembly.compileStreaming'), 'undefined');
+	console.log('pass');
+})().catch(console.error);